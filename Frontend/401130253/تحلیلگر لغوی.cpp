@@ -1,13 +1,44 @@
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
-#include <regex>
 
 using namespace std;
 
+enum class TokenKind : uint8_t {
+    IDENTIFIER,
+    INTEGER,
+    // Keywords
+    IF, ITERATION, PUT, READ, PRINT, VAR, PROGRAM, START, END,
+    // Operators
+    PLUS, MINUS, ASSIGN, GREATER, LESS, EQUAL,
+    // Punctuation
+    COMMA, SEMICOLON, LEFT_PAREN, RIGHT_PAREN, LEFT_BRACE, RIGHT_BRACE,
+    UNKNOWN
+};
+
+string tokenKindName(TokenKind kind) {
+    switch (kind) {
+        case TokenKind::IDENTIFIER: return "Identifier";
+        case TokenKind::INTEGER: return "Integer";
+        case TokenKind::IF: case TokenKind::ITERATION: case TokenKind::PUT: case TokenKind::READ:
+        case TokenKind::PRINT: case TokenKind::VAR: case TokenKind::PROGRAM: case TokenKind::START:
+        case TokenKind::END: return "Keyword";
+        case TokenKind::PLUS: case TokenKind::MINUS: case TokenKind::ASSIGN: case TokenKind::GREATER:
+        case TokenKind::LESS: case TokenKind::EQUAL: return "Operator";
+        case TokenKind::COMMA: case TokenKind::SEMICOLON: case TokenKind::LEFT_PAREN: case TokenKind::RIGHT_PAREN:
+        case TokenKind::LEFT_BRACE: case TokenKind::RIGHT_BRACE: return "Symbol";
+        default: return "Unknown";
+    }
+}
+
+bool isOperator(TokenKind kind) {
+    return kind >= TokenKind::PLUS && kind <= TokenKind::EQUAL;
+}
+
 struct Token {
-    string type;
+    TokenKind kind;
     string value;
     int line;
     int column;
@@ -16,53 +47,114 @@ struct Token {
 class LexicalAnalyzer {
 private:
     vector<Token> tokens;
-    string delimiters = " \\t\\n\\r,;(){}=+-<>";
 
-    bool isIdentifier(const string &word) {
-        return regex_match(word, regex("^[a-zA-Z]{1,5}$"));
+    static bool isDelimiter(char c) {
+        switch (c) {
+            case ' ': case '\t': case '\n': case '\r':
+            case ',': case ';': case '(': case ')': case '{': case '}':
+            case '=': case '+': case '-': case '<': case '>':
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static bool isLetter(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    static bool isDigit(char c) {
+        return c >= '0' && c <= '9';
     }
 
-    bool isInteger(const string &word) {
-        return regex_match(word, regex("^[0-9]+$"));
+    // Keywords by length, then by spelling; at most two comparisons per word.
+    static TokenKind getKeywordKind(const string &word) {
+        switch (word.size()) {
+            case 2: if (word == "If") return TokenKind::IF; break;
+            case 3:
+                if (word == "Put") return TokenKind::PUT;
+                if (word == "Var") return TokenKind::VAR;
+                if (word == "End") return TokenKind::END;
+                break;
+            case 4: if (word == "Read") return TokenKind::READ; break;
+            case 5:
+                if (word == "Print") return TokenKind::PRINT;
+                if (word == "Start") return TokenKind::START;
+                break;
+            case 7: if (word == "Program") return TokenKind::PROGRAM; break;
+            case 9: if (word == "Iteration") return TokenKind::ITERATION; break;
+            default: break;
+        }
+        return TokenKind::UNKNOWN;
+    }
+
+    // One pass over the word decides between keyword, identifier
+    // (^[a-zA-Z]{1,5}$) and integer (^[0-9]+$).
+    static TokenKind getTokenKind(const string &word) {
+        bool allLetters = true, allDigits = true;
+        for (char c : word) {
+            allLetters = allLetters && isLetter(c);
+            allDigits = allDigits && isDigit(c);
+        }
+        if (allLetters) {
+            TokenKind keyword = getKeywordKind(word);
+            if (keyword != TokenKind::UNKNOWN) return keyword;
+            return word.size() <= 5 ? TokenKind::IDENTIFIER : TokenKind::UNKNOWN;
+        }
+        if (allDigits) return TokenKind::INTEGER;
+        return TokenKind::UNKNOWN;
+    }
+
+    static TokenKind getSymbolKind(char c) {
+        switch (c) {
+            case ',': return TokenKind::COMMA;
+            case ';': return TokenKind::SEMICOLON;
+            case '(': return TokenKind::LEFT_PAREN;
+            case ')': return TokenKind::RIGHT_PAREN;
+            case '{': return TokenKind::LEFT_BRACE;
+            case '}': return TokenKind::RIGHT_BRACE;
+            case '=': return TokenKind::ASSIGN;
+            case '+': return TokenKind::PLUS;
+            case '-': return TokenKind::MINUS;
+            case '<': return TokenKind::LESS;
+            case '>': return TokenKind::GREATER;
+            default: return TokenKind::UNKNOWN;
+        }
     }
 
-    string getTokenType(const string &word) {
-        if (isIdentifier(word)) return "Identifier";
-        if (isInteger(word)) return "Integer";
-        if (word == "If" || word == "Iteration" || word == "Put" || word == "Read" || word == "Print" || word == "Var") return "Keyword";
-        if (word == "+" || word == "-" || word == "=" || word == ">" || word == "<" || word == "==") return "Operator";
-        return "Unknown";
+    void addWord(const string &word, int line, int column) {
+        tokens.push_back({getTokenKind(word), word, line, column});
     }
 
 public:
     void analyze(const string &code) {
         tokens.clear();
-        string token;
+        size_t tokenStart = 0;
         int line = 1, column = 0;
         for (size_t i = 0; i < code.size(); ++i) {
             char c = code[i];
             column++;
-            if (delimiters.find(c) != string::npos) {
-                if (!token.empty()) {
-                    string type = getTokenType(token);
-                    tokens.push_back({type, token, line, column - static_cast<int>(token.size())});
-                    token.clear();
+            if (isDelimiter(c)) {
+                if (i > tokenStart) {
+                    addWord(code.substr(tokenStart, i - tokenStart), line, column - static_cast<int>(i - tokenStart));
                 }
-                if (c != ' ' && c != '\\t' && c != '\\n' && c != '\\r') {
+                if (c == '=' && i + 1 < code.size() && code[i + 1] == '=') {
+                    tokens.push_back({TokenKind::EQUAL, "==", line, column});
+                    ++i;
+                    column++;
+                } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
                     string symbol(1, c);
-                    tokens.push_back({"Symbol", symbol, line, column});
+                    tokens.push_back({getSymbolKind(c), symbol, line, column});
                 }
-                if (c == '\\n') {
+                if (c == '\n') {
                     line++;
                     column = 0;
                 }
-            } else {
-                token += c;
+                tokenStart = i + 1;
             }
         }
-        if (!token.empty()) {
-            string type = getTokenType(token);
-            tokens.push_back({type, token, line, column - static_cast<int>(token.size())});
+        if (code.size() > tokenStart) {
+            addWord(code.substr(tokenStart), line, column - static_cast<int>(code.size() - tokenStart));
         }
     }
 
@@ -72,7 +164,7 @@ public:
 
     void printTokens() const {
         for (const auto &token : tokens) {
-            cout << "[Type: " << token.type << ", Value: " << token.value << ", Line: " << token.line << ", Column: " << token.column << "]\n";
+            cout << "[Type: " << tokenKindName(token.kind) << ", Value: " << token.value << ", Line: " << token.line << ", Column: " << token.column << "]\n";
         }
     }
 };
@@ -2,68 +2,179 @@
 #include <fstream>
 #include <string>
 #include <vector>
-#include <memory>
-#include <regex>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
 
 using namespace std;
 
+enum class TokenKind : uint8_t {
+    IDENTIFIER,
+    INTEGER,
+    // Keywords
+    IF, ITERATION, PUT, READ, PRINT, VAR, PROGRAM, START, END,
+    // Operators
+    PLUS, MINUS, ASSIGN, GREATER, LESS, EQUAL,
+    // Punctuation
+    COMMA, SEMICOLON, LEFT_PAREN, RIGHT_PAREN, LEFT_BRACE, RIGHT_BRACE,
+    UNKNOWN,
+    END_OF_INPUT  // Never lexed; what the parser sees once the tokens run out
+};
+
+string tokenKindName(TokenKind kind) {
+    switch (kind) {
+        case TokenKind::IDENTIFIER: return "Identifier";
+        case TokenKind::INTEGER: return "Integer";
+        case TokenKind::IF: case TokenKind::ITERATION: case TokenKind::PUT: case TokenKind::READ:
+        case TokenKind::PRINT: case TokenKind::VAR: case TokenKind::PROGRAM: case TokenKind::START:
+        case TokenKind::END: return "Keyword";
+        case TokenKind::PLUS: case TokenKind::MINUS: case TokenKind::ASSIGN: case TokenKind::GREATER:
+        case TokenKind::LESS: case TokenKind::EQUAL: return "Operator";
+        case TokenKind::COMMA: case TokenKind::SEMICOLON: case TokenKind::LEFT_PAREN: case TokenKind::RIGHT_PAREN:
+        case TokenKind::LEFT_BRACE: case TokenKind::RIGHT_BRACE: return "Symbol";
+        case TokenKind::END_OF_INPUT: return "End of input";
+        default: return "Unknown";
+    }
+}
+
+bool isOperator(TokenKind kind) {
+    return kind >= TokenKind::PLUS && kind <= TokenKind::EQUAL;
+}
+
+// An identifier is at most five ASCII letters, so it fits in a uint64_t with
+// one byte per letter, first letter lowest. Two identifiers are equal exactly
+// when their packed names are, and 0 is never a valid name.
+typedef uint64_t Name;
+const Name NO_NAME = 0;
+
+Name packName(string_view word) {
+    Name name = NO_NAME;
+    for (size_t i = word.size(); i-- > 0;) {
+        name = (name << 8) | static_cast<unsigned char>(word[i]);
+    }
+    return name;
+}
+
 struct Token {
-    string type;
+    TokenKind kind;
     string value;
     int line;
     int column;
+    Name name;  // Packed identifier, NO_NAME for every other kind
 };
 
 class LexicalAnalyzer {
 private:
     vector<Token> tokens;
-    string delimiters = " \\t\\n\\r,;(){}=+-<>";
 
-    bool isIdentifier(const string &word) {
-        return regex_match(word, regex("^[a-zA-Z]{1,5}$"));
+    static bool isDelimiter(char c) {
+        switch (c) {
+            case ' ': case '\t': case '\n': case '\r':
+            case ',': case ';': case '(': case ')': case '{': case '}':
+            case '=': case '+': case '-': case '<': case '>':
+                return true;
+            default:
+                return false;
+        }
     }
 
-    bool isInteger(const string &word) {
-        return regex_match(word, regex("^[0-9]+$"));
+    static bool isLetter(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
     }
 
-    string getTokenType(const string &word) {
-        if (isIdentifier(word)) return "Identifier";
-        if (isInteger(word)) return "Integer";
-        if (word == "If" || word == "Iteration" || word == "Put" || word == "Read" || word == "Print" || word == "Var") return "Keyword";
-        if (word == "+" || word == "-" || word == "=" || word == ">" || word == "<" || word == "==") return "Operator";
-        return "Unknown";
+    static bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    // Keywords by length, then by spelling; at most two comparisons per word.
+    static TokenKind getKeywordKind(const string &word) {
+        switch (word.size()) {
+            case 2: if (word == "If") return TokenKind::IF; break;
+            case 3:
+                if (word == "Put") return TokenKind::PUT;
+                if (word == "Var") return TokenKind::VAR;
+                if (word == "End") return TokenKind::END;
+                break;
+            case 4: if (word == "Read") return TokenKind::READ; break;
+            case 5:
+                if (word == "Print") return TokenKind::PRINT;
+                if (word == "Start") return TokenKind::START;
+                break;
+            case 7: if (word == "Program") return TokenKind::PROGRAM; break;
+            case 9: if (word == "Iteration") return TokenKind::ITERATION; break;
+            default: break;
+        }
+        return TokenKind::UNKNOWN;
+    }
+
+    // One pass over the word decides between keyword, identifier
+    // (^[a-zA-Z]{1,5}$) and integer (^[0-9]+$).
+    static TokenKind getTokenKind(const string &word) {
+        bool allLetters = true, allDigits = true;
+        for (char c : word) {
+            allLetters = allLetters && isLetter(c);
+            allDigits = allDigits && isDigit(c);
+        }
+        if (allLetters) {
+            TokenKind keyword = getKeywordKind(word);
+            if (keyword != TokenKind::UNKNOWN) return keyword;
+            return word.size() <= 5 ? TokenKind::IDENTIFIER : TokenKind::UNKNOWN;
+        }
+        if (allDigits) return TokenKind::INTEGER;
+        return TokenKind::UNKNOWN;
+    }
+
+    static TokenKind getSymbolKind(char c) {
+        switch (c) {
+            case ',': return TokenKind::COMMA;
+            case ';': return TokenKind::SEMICOLON;
+            case '(': return TokenKind::LEFT_PAREN;
+            case ')': return TokenKind::RIGHT_PAREN;
+            case '{': return TokenKind::LEFT_BRACE;
+            case '}': return TokenKind::RIGHT_BRACE;
+            case '=': return TokenKind::ASSIGN;
+            case '+': return TokenKind::PLUS;
+            case '-': return TokenKind::MINUS;
+            case '<': return TokenKind::LESS;
+            case '>': return TokenKind::GREATER;
+            default: return TokenKind::UNKNOWN;
+        }
+    }
+
+    void addWord(const string &word, int line, int column) {
+        TokenKind kind = getTokenKind(word);
+        tokens.push_back({kind, word, line, column, kind == TokenKind::IDENTIFIER ? packName(word) : NO_NAME});
     }
 
 public:
     void analyze(const string &code) {
         tokens.clear();
-        string token;
+        size_t tokenStart = 0;
         int line = 1, column = 0;
         for (size_t i = 0; i < code.size(); ++i) {
             char c = code[i];
             column++;
-            if (delimiters.find(c) != string::npos) {
-                if (!token.empty()) {
-                    string type = getTokenType(token);
-                    tokens.push_back({type, token, line, column - static_cast<int>(token.size())});
-                    token.clear();
+            if (isDelimiter(c)) {
+                if (i > tokenStart) {
+                    addWord(code.substr(tokenStart, i - tokenStart), line, column - static_cast<int>(i - tokenStart));
                 }
-                if (c != ' ' && c != '\\t' && c != '\\n' && c != '\\r') {
+                if (c == '=' && i + 1 < code.size() && code[i + 1] == '=') {
+                    tokens.push_back({TokenKind::EQUAL, "==", line, column, NO_NAME});
+                    ++i;
+                    column++;
+                } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
                     string symbol(1, c);
-                    tokens.push_back({"Symbol", symbol, line, column});
+                    tokens.push_back({getSymbolKind(c), symbol, line, column, NO_NAME});
                 }
-                if (c == '\\n') {
+                if (c == '\n') {
                     line++;
                     column = 0;
                 }
-            } else {
-                token += c;
+                tokenStart = i + 1;
             }
         }
-        if (!token.empty()) {
-            string type = getTokenType(token);
-            tokens.push_back({type, token, line, column - static_cast<int>(token.size())});
+        if (code.size() > tokenStart) {
+            addWord(code.substr(tokenStart), line, column - static_cast<int>(code.size() - tokenStart));
         }
     }
 
@@ -72,10 +183,153 @@ public:
     }
 };
 
+typedef uint32_t NodeId;
+const NodeId NO_NODE = UINT32_MAX;
+
+// A node's value lives in the arena's text buffer and its children are a
+// contiguous range of ASTArena::childIds. Equal values share one offset.
 struct ASTNode {
-    string value;
-    vector<shared_ptr<ASTNode>> children;
-    ASTNode(const string &val) : value(val) {}
+    uint32_t valueOffset;
+    uint32_t valueLength;
+    uint32_t firstChild;
+    uint32_t childCount;
+};
+
+// Owns every node of a tree in a few flat vectors; the whole tree is freed at
+// once when the arena goes away. Children are collected on a stack while their
+// parent is being parsed and copied into childIds when the parent is made.
+class ASTArena {
+private:
+    vector<ASTNode> nodes;
+    vector<NodeId> childIds;
+    vector<NodeId> openChildren;
+    string text;
+    unordered_map<string, uint32_t> textOffsets;  // Each distinct value is stored in `text` once
+
+    uint32_t intern(const string &value) {
+        auto found = textOffsets.find(value);
+        if (found != textOffsets.end()) {
+            return found->second;
+        }
+        uint32_t offset = static_cast<uint32_t>(text.size());
+        text += value;
+        textOffsets.emplace(value, offset);
+        return offset;
+    }
+
+public:
+    size_t mark() const {
+        return openChildren.size();
+    }
+
+    void addChild(NodeId child) {
+        if (child != NO_NODE) {
+            openChildren.push_back(child);
+        }
+    }
+
+    // Makes a node whose children are everything added since `mark`.
+    NodeId make(const string &value, size_t mark) {
+        ASTNode node;
+        node.valueOffset = intern(value);
+        node.valueLength = static_cast<uint32_t>(value.size());
+        node.firstChild = static_cast<uint32_t>(childIds.size());
+        node.childCount = static_cast<uint32_t>(openChildren.size() - mark);
+        childIds.insert(childIds.end(), openChildren.begin() + mark, openChildren.end());
+        openChildren.resize(mark);
+        nodes.push_back(node);
+        return static_cast<NodeId>(nodes.size() - 1);
+    }
+
+    NodeId makeLeaf(const string &value) {
+        return make(value, mark());
+    }
+
+    string_view value(NodeId id) const {
+        return string_view(text).substr(nodes[id].valueOffset, nodes[id].valueLength);
+    }
+
+    size_t childCount(NodeId id) const {
+        return nodes[id].childCount;
+    }
+
+    NodeId child(NodeId id, size_t index) const {
+        return childIds[nodes[id].firstChild + index];
+    }
+
+    size_t size() const {
+        return nodes.size();
+    }
+
+    size_t bytesUsed() const {
+        return nodes.capacity() * sizeof(ASTNode) + childIds.capacity() * sizeof(NodeId) + text.capacity() +
+               textOffsets.size() * (sizeof(string) + sizeof(uint32_t) + sizeof(void *)) +
+               textOffsets.bucket_count() * sizeof(void *);
+    }
+
+    void clear() {
+        nodes.clear();
+        childIds.clear();
+        openChildren.clear();
+        text.clear();
+        textOffsets.clear();
+    }
+};
+
+// Declared variables keyed on their packed names. Open addressing in a
+// power-of-two array sized up front to stay under half full, so declaring
+// and looking up never allocate and probe runs stay short: a probe is a
+// multiply, a shift and usually a single integer comparison.
+class SymbolTable {
+private:
+    struct Entry {
+        Name name;
+        int line;
+    };
+
+    vector<Entry> entries;
+    int shift;  // 64 - log2(entries.size()), so home() yields a slot index
+    size_t count = 0;
+
+    size_t home(Name name) const {
+        return static_cast<size_t>((name * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    size_t find(Name name) const {
+        size_t slot = home(name);
+        while (entries[slot].name != NO_NAME && entries[slot].name != name) {
+            slot = (slot + 1) & (entries.size() - 1);
+        }
+        return slot;
+    }
+
+public:
+    // Room for `maxNames` declarations
+    explicit SymbolTable(size_t maxNames) {
+        size_t size = 2;
+        for (shift = 63; size < 2 * maxNames + 2; size *= 2) {
+            shift--;
+        }
+        entries.assign(size, Entry{NO_NAME, 0});
+    }
+
+    // Records `name` as declared on `line`; a name declared again keeps its
+    // first line. At most maxNames different names may be declared.
+    void declare(Name name, int line) {
+        size_t slot = find(name);
+        if (entries[slot].name == name) return;
+        entries[slot] = {name, line};
+        count++;
+    }
+
+    // The line `name` was declared on, or 0 if it was never declared.
+    int declaredAt(Name name) const {
+        return entries[find(name)].line;
+    }
+
+    size_t size() const {
+        return count;
+    }
 };
 
 class Parser {
@@ -83,119 +337,201 @@ private:
     vector<Token> tokens;
     int currentIndex;
     Token currentToken;
+    ASTArena &arena;
+    SymbolTable symbols;
+    vector<string> diagnostics;
+    bool panicking = false;  // From a syntax error until synchronize() finds where to resume
 
     void advance() {
         if (currentIndex < tokens.size()) {
             currentToken = tokens[currentIndex++];
+        } else if (!tokens.empty()) {
+            // Out of tokens; point diagnostics just past the last one
+            const Token &last = tokens.back();
+            currentToken = {TokenKind::END_OF_INPUT, "", last.line, last.column + static_cast<int>(last.value.size()), NO_NAME};
+        } else {
+            currentToken = {TokenKind::END_OF_INPUT, "", 1, 1, NO_NAME};
         }
     }
 
-    bool match(const string &type) {
-        return currentToken.type == type;
+    bool match(TokenKind kind) {
+        return currentToken.kind == kind;
     }
 
+    // Records a syntax error unless an earlier one is still being recovered
+    // from; those that follow from it are not worth reporting.
     void error(const string &message) {
-        cerr << "Syntax Error: " << message << " at line " << currentToken.line << ", column " << currentToken.column << endl;
-        exit(1);
+        if (!panicking) {
+            diagnostics.push_back("Syntax Error: " + message + " at line " + to_string(currentToken.line) + ", column " + to_string(currentToken.column));
+        }
+        panicking = true;
+    }
+
+    void semanticError(const string &message) {
+        diagnostics.push_back("Semantic Error: " + message + " at line " + to_string(currentToken.line) + ", column " + to_string(currentToken.column));
+    }
+
+    // Each 'Var' declares at most one name, which bounds the symbol table
+    static size_t countDeclarations(const vector<Token> &tokens) {
+        size_t count = 0;
+        for (const Token &token : tokens) {
+            count += token.kind == TokenKind::VAR;
+        }
+        return count;
+    }
+
+    void declareCurrent() {
+        int previous = symbols.declaredAt(currentToken.name);
+        if (previous != 0) {
+            semanticError("Variable '" + currentToken.value + "' redeclared (first declared on line " + to_string(previous) + ").");
+        }
+        symbols.declare(currentToken.name, currentToken.line);
+    }
+
+    // Variables are all declared in the Vars section, ahead of every use
+    void useCurrent() {
+        if (symbols.declaredAt(currentToken.name) == 0) {
+            semanticError("Undeclared variable '" + currentToken.value + "'.");
+        }
     }
 
-    shared_ptr<ASTNode> parseProgram() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("Program");
-        if (match("Keyword") && currentToken.value == "Program") {
+    static bool startsState(TokenKind kind) {
+        switch (kind) {
+            case TokenKind::IF: case TokenKind::ITERATION: case TokenKind::PUT:
+            case TokenKind::READ: case TokenKind::PRINT:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Panic mode: skips to a token parsing can resume from, which is just past
+    // a ';' or at a statement keyword, 'Var', 'Start', 'End' or the '}' of an
+    // enclosing block. A block opened while skipping is skipped whole.
+    void synchronize() {
+        int depth = 0;
+        while (!match(TokenKind::END_OF_INPUT)) {
+            if (depth == 0 && (startsState(currentToken.kind) || match(TokenKind::VAR) || match(TokenKind::START) ||
+                               match(TokenKind::END) || match(TokenKind::RIGHT_BRACE))) {
+                break;
+            }
+            TokenKind skipped = currentToken.kind;
             advance();
-            node->children.push_back(parseVars());
-            node->children.push_back(parseBlocks());
-            if (match("Keyword") && currentToken.value == "end") {
-                advance();
-            } else {
-                error("Expected 'end' after Program block.");
+            if (skipped == TokenKind::LEFT_BRACE) {
+                depth++;
+            } else if (skipped == TokenKind::RIGHT_BRACE) {
+                if (--depth == 0) break;
+            } else if (skipped == TokenKind::SEMICOLON && depth == 0) {
+                break;
             }
+        }
+        panicking = false;
+    }
+
+    NodeId parseProgram() {
+        size_t mark = arena.mark();
+        if (match(TokenKind::PROGRAM)) {
+            advance();
         } else {
             error("Expected 'Program' keyword.");
+            synchronize();
         }
-        return node;
+        arena.addChild(parseVars());
+        arena.addChild(parseBlocks());
+        if (match(TokenKind::END)) {
+            advance();
+        } else {
+            error("Expected 'End' after Program block.");
+        }
+        return arena.make("Program", mark);
     }
 
-    shared_ptr<ASTNode> parseVars() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("Vars");
-        if (match("Keyword") && currentToken.value == "Var") {
+    NodeId parseVars() {
+        size_t mark = arena.mark();
+        if (match(TokenKind::VAR)) {
             advance();
-            if (match("Identifier")) {
-                node->children.push_back(make_shared<ASTNode>(currentToken.value));
+            if (match(TokenKind::IDENTIFIER)) {
+                declareCurrent();
+                arena.addChild(arena.makeLeaf(currentToken.value));
                 advance();
-                if (match("Symbol") && currentToken.value == ";") {
+                if (match(TokenKind::SEMICOLON)) {
                     advance();
-                    node->children.push_back(parseVars());
+                    arena.addChild(parseVars());
                 } else {
                     error("Expected ';' after variable declaration.");
                 }
             } else {
                 error("Expected Identifier after 'Var'.");
             }
+            if (panicking) {
+                synchronize();
+                arena.addChild(parseVars());
+            }
         }
-        return node;
+        return arena.make("Vars", mark);
     }
 
-    shared_ptr<ASTNode> parseBlocks() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("Blocks");
-        if (match("Keyword") && currentToken.value == "Start") {
+    NodeId parseBlocks() {
+        size_t mark = arena.mark();
+        if (match(TokenKind::START)) {
             advance();
-            node->children.push_back(parseStates());
-            if (match("Keyword") && currentToken.value == "End") {
-                advance();
-            } else {
-                error("Expected 'End' after block.");
-            }
         } else {
             error("Expected 'Start' keyword.");
+            synchronize();
         }
-        return node;
+        arena.addChild(parseStates());
+        if (match(TokenKind::END)) {
+            advance();
+        } else {
+            error("Expected 'End' after block.");
+            synchronize();
+        }
+        return arena.make("Blocks", mark);
     }
 
-    shared_ptr<ASTNode> parseStates() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("States");
-        node->children.push_back(parseState());
-        node->children.push_back(parseMStates());
-        return node;
+    NodeId parseStates() {
+        size_t mark = arena.mark();
+        arena.addChild(parseState());
+        arena.addChild(parseMStates());
+        return arena.make("States", mark);
     }
 
-    shared_ptr<ASTNode> parseState() {
-        if (match("Keyword") && (currentToken.value == "If" || currentToken.value == "Iteration" ||
-            currentToken.value == "Put" || currentToken.value == "Read" || currentToken.value == "Print")) {
-            if (currentToken.value == "If") {
-                return parseIf();
-            } else if (currentToken.value == "Iteration") {
-                return parseLoop();
-            } else if (currentToken.value == "Put") {
-                return parseAssign();
-            } else if (currentToken.value == "Read") {
-                return parseIn();
-            } else if (currentToken.value == "Print") {
-                return parseOut();
-            }
+    // A statement that fails to parse still yields its partial node; the
+    // input is then skipped to where the next statement can start.
+    NodeId parseState() {
+        NodeId node;
+        switch (currentToken.kind) {
+            case TokenKind::IF: node = parseIf(); break;
+            case TokenKind::ITERATION: node = parseLoop(); break;
+            case TokenKind::PUT: node = parseAssign(); break;
+            case TokenKind::READ: node = parseIn(); break;
+            case TokenKind::PRINT: node = parseOut(); break;
+            default: return NO_NODE;
         }
-        return nullptr;
+        if (panicking) {
+            synchronize();
+        }
+        return node;
     }
 
-    shared_ptr<ASTNode> parseMStates() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("MStates");
-        if (match("Keyword") && (currentToken.value == "If" || currentToken.value == "Iteration" ||
-            currentToken.value == "Put" || currentToken.value == "Read" || currentToken.value == "Print")) {
-            node->children.push_back(parseStates());
+    NodeId parseMStates() {
+        size_t mark = arena.mark();
+        if (startsState(currentToken.kind)) {
+            arena.addChild(parseStates());
         }
-        return node;
+        return arena.make("MStates", mark);
     }
 
-    shared_ptr<ASTNode> parseOut() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("Out");
-        if (match("Keyword") && currentToken.value == "Print") {
+    NodeId parseOut() {
+        size_t mark = arena.mark();
+        if (match(TokenKind::PRINT)) {
             advance();
-            if (match("Symbol") && currentToken.value == "(") {
+            if (match(TokenKind::LEFT_PAREN)) {
                 advance();
-                node->children.push_back(parseExpr());
-                if (match("Symbol") && currentToken.value == ")") {
+                arena.addChild(parseExpr());
+                if (match(TokenKind::RIGHT_PAREN)) {
                     advance();
-                    if (match("Symbol") && currentToken.value == ";") {
+                    if (match(TokenKind::SEMICOLON)) {
                         advance();
                     } else {
                         error("Expected ';' after Print statement.");
@@ -209,21 +545,22 @@ private:
         } else {
             error("Expected 'Print' keyword.");
         }
-        return node;
+        return arena.make("Out", mark);
     }
 
-    shared_ptr<ASTNode> parseIn() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("In");
-        if (match("Keyword") && currentToken.value == "Read") {
+    NodeId parseIn() {
+        size_t mark = arena.mark();
+        if (match(TokenKind::READ)) {
             advance();
-            if (match("Symbol") && currentToken.value == "(") {
+            if (match(TokenKind::LEFT_PAREN)) {
                 advance();
-                if (match("Identifier")) {
-                    node->children.push_back(make_shared<ASTNode>(currentToken.value));
+                if (match(TokenKind::IDENTIFIER)) {
+                    useCurrent();
+                    arena.addChild(arena.makeLeaf(currentToken.value));
                     advance();
-                    if (match("Symbol") && currentToken.value == ")") {
+                    if (match(TokenKind::RIGHT_PAREN)) {
                         advance();
-                        if (match("Symbol") && currentToken.value == ";") {
+                        if (match(TokenKind::SEMICOLON)) {
                             advance();
                         } else {
                             error("Expected ';' after Read statement.");
@@ -240,25 +577,25 @@ private:
         } else {
             error("Expected 'Read' keyword.");
         }
-        return node;
+        return arena.make("In", mark);
     }
 
-    shared_ptr<ASTNode> parseIf() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("If");
-        if (match("Keyword") && currentToken.value == "If") {
+    NodeId parseIf() {
+        size_t mark = arena.mark();
+        if (match(TokenKind::IF)) {
             advance();
-            if (match("Symbol") && currentToken.value == "(") {
+            if (match(TokenKind::LEFT_PAREN)) {
                 advance();
-                node->children.push_back(parseExpr());
-                if (match("Operator")) {
+                arena.addChild(parseExpr());
+                if (isOperator(currentToken.kind)) {
                     advance();
-                    node->children.push_back(parseExpr());
-                    if (match("Symbol") && currentToken.value == ")") {
+                    arena.addChild(parseExpr());
+                    if (match(TokenKind::RIGHT_PAREN)) {
                         advance();
-                        if (match("Symbol") && currentToken.value == "{") {
+                        if (match(TokenKind::LEFT_BRACE)) {
                             advance();
-                            node->children.push_back(parseState());
-                            if (match("Symbol") && currentToken.value == "}") {
+                            arena.addChild(parseState());
+                            if (match(TokenKind::RIGHT_BRACE)) {
                                 advance();
                             } else {
                                 error("Expected '}' after If body.");
@@ -278,25 +615,25 @@ private:
         } else {
             error("Expected 'If' keyword.");
         }
-        return node;
+        return arena.make("If", mark);
     }
 
-    shared_ptr<ASTNode> parseLoop() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("Loop");
-        if (match("Keyword") && currentToken.value == "Iteration") {
+    NodeId parseLoop() {
+        size_t mark = arena.mark();
+        if (match(TokenKind::ITERATION)) {
             advance();
-            if (match("Symbol") && currentToken.value == "(") {
+            if (match(TokenKind::LEFT_PAREN)) {
                 advance();
-                node->children.push_back(parseExpr());
-                if (match("Operator")) {
+                arena.addChild(parseExpr());
+                if (isOperator(currentToken.kind)) {
                     advance();
-                    node->children.push_back(parseExpr());
-                    if (match("Symbol") && currentToken.value == ")") {
+                    arena.addChild(parseExpr());
+                    if (match(TokenKind::RIGHT_PAREN)) {
                         advance();
-                        if (match("Symbol") && currentToken.value == "{") {
+                        if (match(TokenKind::LEFT_BRACE)) {
                             advance();
-                            node->children.push_back(parseState());
-                            if (match("Symbol") && currentToken.value == "}") {
+                            arena.addChild(parseState());
+                            if (match(TokenKind::RIGHT_BRACE)) {
                                 advance();
                             } else {
                                 error("Expected '}' after Loop body.");
@@ -316,20 +653,21 @@ private:
         } else {
             error("Expected 'Iteration' keyword.");
         }
-        return node;
+        return arena.make("Loop", mark);
     }
 
-    shared_ptr<ASTNode> parseAssign() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("Assign");
-        if (match("Keyword") && currentToken.value == "Put") {
+    NodeId parseAssign() {
+        size_t mark = arena.mark();
+        if (match(TokenKind::PUT)) {
             advance();
-            if (match("Identifier")) {
-                node->children.push_back(make_shared<ASTNode>(currentToken.value));
+            if (match(TokenKind::IDENTIFIER)) {
+                useCurrent();
+                arena.addChild(arena.makeLeaf(currentToken.value));
                 advance();
-                if (match("Operator") && currentToken.value == "=") {
+                if (match(TokenKind::ASSIGN)) {
                     advance();
-                    node->children.push_back(parseExpr());
-                    if (match("Symbol") && currentToken.value == ";") {
+                    arena.addChild(parseExpr());
+                    if (match(TokenKind::SEMICOLON)) {
                         advance();
                     } else {
                         error("Expected ';' after Assignment.");
@@ -343,42 +681,134 @@ private:
         } else {
             error("Expected 'Put' keyword.");
         }
-        return node;
+        return arena.make("Assign", mark);
     }
 
-    shared_ptr<ASTNode> parseExpr() {
-        shared_ptr<ASTNode> node = parseR();
-        while (match("Operator") && (currentToken.value == "+" || currentToken.value == "-")) {
-            shared_ptr<ASTNode> operatorNode = make_shared<ASTNode>(currentToken.value);
-            advance();
-            operatorNode->children.push_back(node);
-            operatorNode->children.push_back(parseR());
-            node = operatorNode;
+    // Binding power of a binary operator inside an expression; higher binds
+    // tighter and 0 ends the expression. Comparisons are not expression
+    // operators: they only join the two sides of an If or Iteration condition.
+    static int binaryPower(TokenKind kind) {
+        switch (kind) {
+            case TokenKind::PLUS: case TokenKind::MINUS: return 1;
+            default: return 0;
         }
-        return node;
     }
 
-    shared_ptr<ASTNode> parseR() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("R");
-        if (match("Identifier")) {
-            node->children.push_back(make_shared<ASTNode>(currentToken.value));
+    static const int PREFIX_POWER = 2;  // Unary + and -, above every binary operator
+
+    struct PendingOperator {
+        string value;
+        int power;
+        int arity;  // 0 marks an open parenthesis
+    };
+
+    vector<PendingOperator> pendingOperators;  // Reused by every parseExpr
+    vector<NodeId> pendingOperands;
+
+    // Pops the top operator and the operands it takes into one node.
+    void reduce() {
+        PendingOperator op = pendingOperators.back();
+        pendingOperators.pop_back();
+        size_t mark = arena.mark();
+        size_t first = pendingOperands.size() - op.arity;
+        for (size_t i = first; i < pendingOperands.size(); i++) {
+            arena.addChild(pendingOperands[i]);
+        }
+        pendingOperands.resize(first);
+        pendingOperands.push_back(arena.make(op.value, mark));
+    }
+
+    // Operator precedence (Pratt / shunting-yard) over explicit stacks:
+    // operands wait until the operator that takes them is reduced, so neither
+    // parentheses nor long chains recurse. Binary operators become a node with
+    // both sides as children, unary ones a node with one child.
+    NodeId parseExpr() {
+        pendingOperators.clear();
+        pendingOperands.clear();
+        size_t openParens = 0;
+        bool expectOperand = true;
+        while (true) {
+            if (expectOperand) {
+                if (match(TokenKind::LEFT_PAREN)) {
+                    pendingOperators.push_back({"(", 0, 0});
+                    openParens++;
+                    advance();
+                } else if (match(TokenKind::PLUS) || match(TokenKind::MINUS)) {
+                    pendingOperators.push_back({currentToken.value, PREFIX_POWER, 1});
+                    advance();
+                } else {
+                    pendingOperands.push_back(parseR());
+                    expectOperand = false;
+                }
+                continue;
+            }
+            int power = binaryPower(currentToken.kind);
+            if (power != 0) {
+                // Left-associative: anything pending that binds at least as tightly goes first
+                while (!pendingOperators.empty() && pendingOperators.back().arity != 0 && pendingOperators.back().power >= power) {
+                    reduce();
+                }
+                pendingOperators.push_back({currentToken.value, power, 2});
+                advance();
+                expectOperand = true;
+            } else if (openParens > 0 && match(TokenKind::RIGHT_PAREN)) {
+                while (pendingOperators.back().arity != 0) {
+                    reduce();
+                }
+                pendingOperators.pop_back();
+                openParens--;
+                advance();
+            } else {
+                break;
+            }
+        }
+        if (openParens > 0) {
+            error("Expected ')' in expression.");
+        }
+        // Parentheses left open by an error are dropped; only operators make nodes
+        while (!pendingOperators.empty()) {
+            if (pendingOperators.back().arity == 0) {
+                pendingOperators.pop_back();
+            } else {
+                reduce();
+            }
+        }
+        return pendingOperands.back();
+    }
+
+    NodeId parseR() {
+        size_t mark = arena.mark();
+        if (match(TokenKind::IDENTIFIER)) {
+            useCurrent();
+            arena.addChild(arena.makeLeaf(currentToken.value));
             advance();
-        } else if (match("Integer")) {
-            node->children.push_back(make_shared<ASTNode>(currentToken.value));
+        } else if (match(TokenKind::INTEGER)) {
+            arena.addChild(arena.makeLeaf(currentToken.value));
             advance();
         } else {
-            error("Expected Identifier or Integer.");
+            error("Expected Identifier, Integer or '('.");
         }
-        return node;
+        return arena.make("R", mark);
     }
 
 public:
-    Parser(const vector<Token> &tokens) : tokens(tokens), currentIndex(0) {
+    Parser(const vector<Token> &tokens, ASTArena &arena)
+        : tokens(tokens), currentIndex(0), arena(arena), symbols(countDeclarations(tokens)) {
         advance();
     }
 
-    shared_ptr<ASTNode> parse() {
+    // Builds the tree into the arena and returns its root.
+    NodeId parse() {
         return parseProgram();
     }
+
+    const SymbolTable &getSymbols() const {
+        return symbols;
+    }
+
+    // Every syntax and semantic error parse() found, in source order
+    const vector<string> &getDiagnostics() const {
+        return diagnostics;
+    }
 };
 
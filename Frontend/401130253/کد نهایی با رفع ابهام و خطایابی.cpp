@@ -1,156 +1,1104 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <fstream>
+#include <functional>
+#include <iterator>
 #include <string>
 #include <vector>
-#include <memory>
-#include <regex>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 
 using namespace std;
 
+enum class TokenKind : uint8_t {
+    IDENTIFIER,
+    INTEGER,
+    // Keywords
+    IF, ITERATION, PUT, READ, PRINT, VAR, PROGRAM, START, END,
+    // Operators
+    PLUS, MINUS, ASSIGN, GREATER, LESS, EQUAL,
+    // Punctuation
+    COMMA, SEMICOLON, LEFT_PAREN, RIGHT_PAREN, LEFT_BRACE, RIGHT_BRACE,
+    UNKNOWN,
+    END_OF_INPUT  // Never lexed; what the parser sees once the tokens run out
+};
+
+string tokenKindName(TokenKind kind) {
+    switch (kind) {
+        case TokenKind::IDENTIFIER: return "Identifier";
+        case TokenKind::INTEGER: return "Integer";
+        case TokenKind::IF: case TokenKind::ITERATION: case TokenKind::PUT: case TokenKind::READ:
+        case TokenKind::PRINT: case TokenKind::VAR: case TokenKind::PROGRAM: case TokenKind::START:
+        case TokenKind::END: return "Keyword";
+        case TokenKind::PLUS: case TokenKind::MINUS: case TokenKind::ASSIGN: case TokenKind::GREATER:
+        case TokenKind::LESS: case TokenKind::EQUAL: return "Operator";
+        case TokenKind::COMMA: case TokenKind::SEMICOLON: case TokenKind::LEFT_PAREN: case TokenKind::RIGHT_PAREN:
+        case TokenKind::LEFT_BRACE: case TokenKind::RIGHT_BRACE: return "Symbol";
+        case TokenKind::END_OF_INPUT: return "End of input";
+        default: return "Unknown";
+    }
+}
+
+bool isOperator(TokenKind kind) {
+    return kind >= TokenKind::PLUS && kind <= TokenKind::EQUAL;
+}
+
+// An identifier is at most five ASCII letters, so it fits in a uint64_t with
+// one byte per letter, first letter lowest. Two identifiers are equal exactly
+// when their packed names are, and 0 is never a valid name.
+typedef uint64_t Name;
+const Name NO_NAME = 0;
+
+Name packName(string_view word) {
+    Name name = NO_NAME;
+    for (size_t i = word.size(); i-- > 0;) {
+        name = (name << 8) | static_cast<unsigned char>(word[i]);
+    }
+    return name;
+}
+
 struct Token {
-    string type;
+    TokenKind kind;
     string value;
     int line;
     int column;
+    Name name;  // Packed identifier, NO_NAME for every other kind
 };
 
 class LexicalAnalyzer {
 private:
     vector<Token> tokens;
-    string delimiters = " \t\n\r,;(){}=+-<>";
+    vector<size_t> lineStarts;  // Where each line of the code last lexed starts, line 1 first
+    size_t codeSize = 0;        // and how long that code was
 
-    bool isIdentifier(const string &word) {
-        return regex_match(word, regex("^[a-zA-Z]{1,5}$"));
+    static bool isDelimiter(char c) {
+        switch (c) {
+            case ' ': case '\t': case '\n': case '\r':
+            case ',': case ';': case '(': case ')': case '{': case '}':
+            case '=': case '+': case '-': case '<': case '>':
+                return true;
+            default:
+                return false;
+        }
     }
 
-    bool isInteger(const string &word) {
-        return regex_match(word, regex("^[0-9]+$"));
+    static bool isLetter(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
     }
 
-    string getTokenType(const string &word) {
-        if (isIdentifier(word)) return "Identifier";
-        if (isInteger(word)) return "Integer";
-        if (word == "If" || word == "Iteration" || word == "Put" || word == "Read" || word == "Print" || word == "Var") return "Keyword";
-        if (word == "+" || word == "-" || word == "=" || word == ">" || word == "<" || word == "==") return "Operator";
-        return "Unknown";
+    static bool isDigit(char c) {
+        return c >= '0' && c <= '9';
     }
 
-public:
-    void analyze(const string &code) {
-        tokens.clear();
-        string token;
-        int line = 1, column = 0;
-        for (size_t i = 0; i < code.size(); ++i) {
+    // Keywords by length, then by spelling; at most two comparisons per word.
+    static TokenKind getKeywordKind(const string &word) {
+        switch (word.size()) {
+            case 2: if (word == "If") return TokenKind::IF; break;
+            case 3:
+                if (word == "Put") return TokenKind::PUT;
+                if (word == "Var") return TokenKind::VAR;
+                if (word == "End") return TokenKind::END;
+                break;
+            case 4: if (word == "Read") return TokenKind::READ; break;
+            case 5:
+                if (word == "Print") return TokenKind::PRINT;
+                if (word == "Start") return TokenKind::START;
+                break;
+            case 7: if (word == "Program") return TokenKind::PROGRAM; break;
+            case 9: if (word == "Iteration") return TokenKind::ITERATION; break;
+            default: break;
+        }
+        return TokenKind::UNKNOWN;
+    }
+
+    // One pass over the word decides between keyword, identifier
+    // (^[a-zA-Z]{1,5}$) and integer (^[0-9]+$).
+    static TokenKind getTokenKind(const string &word) {
+        bool allLetters = true, allDigits = true;
+        for (char c : word) {
+            allLetters = allLetters && isLetter(c);
+            allDigits = allDigits && isDigit(c);
+        }
+        if (allLetters) {
+            TokenKind keyword = getKeywordKind(word);
+            if (keyword != TokenKind::UNKNOWN) return keyword;
+            return word.size() <= 5 ? TokenKind::IDENTIFIER : TokenKind::UNKNOWN;
+        }
+        if (allDigits) return TokenKind::INTEGER;
+        return TokenKind::UNKNOWN;
+    }
+
+    static TokenKind getSymbolKind(char c) {
+        switch (c) {
+            case ',': return TokenKind::COMMA;
+            case ';': return TokenKind::SEMICOLON;
+            case '(': return TokenKind::LEFT_PAREN;
+            case ')': return TokenKind::RIGHT_PAREN;
+            case '{': return TokenKind::LEFT_BRACE;
+            case '}': return TokenKind::RIGHT_BRACE;
+            case '=': return TokenKind::ASSIGN;
+            case '+': return TokenKind::PLUS;
+            case '-': return TokenKind::MINUS;
+            case '<': return TokenKind::LESS;
+            case '>': return TokenKind::GREATER;
+            default: return TokenKind::UNKNOWN;
+        }
+    }
+
+    static void addWord(vector<Token> &out, const string &word, int line, int column) {
+        TokenKind kind = getTokenKind(word);
+        out.push_back({kind, word, line, column, kind == TokenKind::IDENTIFIER ? packName(word) : NO_NAME});
+    }
+
+    // Lexes code[begin, end), which starts at the start of line `line`.
+    static void analyzeRange(const string &code, size_t begin, size_t end, int line, vector<Token> &out) {
+        size_t tokenStart = begin;
+        int column = 0;
+        for (size_t i = begin; i < end; ++i) {
             char c = code[i];
             column++;
-            if (delimiters.find(c) != string::npos) {
-                if (!token.empty()) {
-                    string type = getTokenType(token);
-                    tokens.push_back({type, token, line, column - static_cast<int>(token.size())});
-                    token.clear();
+            if (isDelimiter(c)) {
+                if (i > tokenStart) {
+                    addWord(out, code.substr(tokenStart, i - tokenStart), line, column - static_cast<int>(i - tokenStart));
                 }
-                if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                if (c == '=' && i + 1 < end && code[i + 1] == '=') {
+                    out.push_back({TokenKind::EQUAL, "==", line, column, NO_NAME});
+                    ++i;
+                    column++;
+                } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
                     string symbol(1, c);
-                    tokens.push_back({"Symbol", symbol, line, column});
+                    out.push_back({getSymbolKind(c), symbol, line, column, NO_NAME});
                 }
                 if (c == '\n') {
                     line++;
                     column = 0;
                 }
-            } else {
-                token += c;
+                tokenStart = i + 1;
             }
         }
-        if (!token.empty()) {
-            string type = getTokenType(token);
-            tokens.push_back({type, token, line, column - static_cast<int>(token.size())});
+        if (end > tokenStart) {
+            addWord(out, code.substr(tokenStart, end - tokenStart), line, column - static_cast<int>(end - tokenStart));
+        }
+    }
+
+    // Where `count` more lines start after `from`, or the end of the code
+    static size_t skipLines(const string &code, size_t from, int count) {
+        for (; count > 0 && from < code.size(); count--) {
+            size_t newline = code.find('\n', from);
+            from = newline == string::npos ? code.size() : newline + 1;
+        }
+        return from;
+    }
+
+    // Appends where each line in code[begin, end) starts; a line starts at
+    // `begin` and after every newline but one at the very end.
+    static void findLineStarts(const string &code, size_t begin, size_t end, vector<size_t> &out) {
+        for (size_t at = begin; at < end;) {
+            out.push_back(at);
+            size_t newline = code.find('\n', at);
+            at = newline == string::npos ? end : newline + 1;
         }
     }
 
+    // Where `line` started in the code last lexed, or its end if it had fewer lines
+    size_t lineStart(int line) const {
+        return static_cast<size_t>(line - 1) < lineStarts.size() ? lineStarts[line - 1] : codeSize;
+    }
+
+public:
+    void analyze(const string &code) {
+        tokens.clear();
+        analyzeRange(code, 0, code.size(), 1, tokens);
+        lineStarts.clear();
+        findLineStarts(code, 0, code.size(), lineStarts);
+        if (code.empty() || code.back() == '\n') lineStarts.push_back(code.size());
+        codeSize = code.size();
+    }
+
+    // Brings the tokens up to date after an edit replaced lines [firstLine,
+    // firstLine + oldLineCount) with newLineCount lines; `code` is the whole
+    // source after the edit. Only the new lines are lexed, and the edit is
+    // found from the line starts kept since the last analyze, not by reading
+    // the code before it. The new tokens take the place of the old lines' and
+    // the tokens after keep their text: an edit that keeps the number of
+    // tokens and lines touches no token past itself, any other moves them
+    // once, renumbering their lines on the way. The result is what
+    // analyze(code) would give.
+    void reanalyze(const string &code, int firstLine, int oldLineCount, int newLineCount) {
+        if (firstLine < 1 || oldLineCount < 0 || newLineCount < 0 ||
+            static_cast<size_t>(firstLine - 1) > lineStarts.size()) {
+            analyze(code);
+            return;
+        }
+        // The lines before the edit did not move, so it starts where it did
+        size_t begin = lineStart(firstLine);
+        size_t oldEnd = lineStart(firstLine + oldLineCount);
+        size_t end = skipLines(code, begin, newLineCount);
+        vector<Token> fresh;
+        analyzeRange(code, begin, end, firstLine, fresh);
+
+        // The line starts after the edit move by as much as its text grew
+        size_t firstStart = static_cast<size_t>(firstLine - 1);
+        size_t oldStartsEnd = min(lineStarts.size(), firstStart + static_cast<size_t>(oldLineCount));
+        vector<size_t> newStarts;
+        findLineStarts(code, begin, end, newStarts);
+        if (oldStartsEnd == lineStarts.size() && end == code.size() && (code.empty() || code.back() == '\n')) {
+            newStarts.push_back(end);  // The empty line after a final newline
+        }
+        lineStarts.erase(lineStarts.begin() + firstStart, lineStarts.begin() + oldStartsEnd);
+        lineStarts.insert(lineStarts.begin() + firstStart, newStarts.begin(), newStarts.end());
+        for (size_t i = firstStart + newStarts.size(); i < lineStarts.size(); i++) {
+            lineStarts[i] = lineStarts[i] - oldEnd + end;
+        }
+        codeSize = code.size();
+
+        auto before = [](const Token &token, int line) { return token.line < line; };
+        auto from = lower_bound(tokens.begin(), tokens.end(), firstLine, before);
+        auto to = lower_bound(from, tokens.end(), firstLine + oldLineCount, before);
+        size_t firstToken = from - tokens.begin();
+        size_t oldEndToken = to - tokens.begin();
+        size_t newEndToken = firstToken + fresh.size();
+        size_t tail = tokens.size() - oldEndToken;
+        int lineShift = newLineCount - oldLineCount;
+        if (newEndToken > oldEndToken) {
+            tokens.resize(newEndToken + tail);
+            for (size_t i = tail; i-- > 0;) {  // Last first, so nothing is overwritten before it moves
+                tokens[newEndToken + i] = move(tokens[oldEndToken + i]);
+                tokens[newEndToken + i].line += lineShift;
+            }
+        } else if (newEndToken < oldEndToken) {
+            for (size_t i = 0; i < tail; i++) {
+                tokens[newEndToken + i] = move(tokens[oldEndToken + i]);
+                tokens[newEndToken + i].line += lineShift;
+            }
+            tokens.resize(newEndToken + tail);
+        } else if (lineShift != 0) {
+            for (size_t i = oldEndToken; i < tokens.size(); i++) {
+                tokens[i].line += lineShift;
+            }
+        }
+        move(fresh.begin(), fresh.end(), tokens.begin() + firstToken);
+    }
+
     const vector<Token> &getTokens() const {
         return tokens;
     }
 };
 
+typedef uint32_t NodeId;
+const NodeId NO_NODE = UINT32_MAX;
+
+// A node's value lives in the arena's text buffer and its children are a
+// contiguous range of ASTArena::childIds. Equal values share one offset.
 struct ASTNode {
-    string value;
-    vector<shared_ptr<ASTNode>> children;
-    ASTNode(const string &val) : value(val) {}
+    uint32_t valueOffset;
+    uint32_t valueLength;
+    uint32_t firstChild;
+    uint32_t childCount;
+};
+
+// Owns every node of a tree in a few flat vectors; the whole tree is freed at
+// once when the arena goes away. Children are collected on a stack while their
+// parent is being parsed and copied into childIds when the parent is made.
+class ASTArena {
+private:
+    vector<ASTNode> nodes;
+    vector<NodeId> childIds;
+    vector<NodeId> openChildren;
+    string text;
+    unordered_map<string, uint32_t> textOffsets;  // Each distinct value is stored in `text` once
+
+    uint32_t intern(const string &value) {
+        auto found = textOffsets.find(value);
+        if (found != textOffsets.end()) {
+            return found->second;
+        }
+        uint32_t offset = static_cast<uint32_t>(text.size());
+        text += value;
+        textOffsets.emplace(value, offset);
+        return offset;
+    }
+
+public:
+    size_t mark() const {
+        return openChildren.size();
+    }
+
+    void addChild(NodeId child) {
+        if (child != NO_NODE) {
+            openChildren.push_back(child);
+        }
+    }
+
+    // Makes a node whose children are everything added since `mark`.
+    NodeId make(const string &value, size_t mark) {
+        ASTNode node;
+        node.valueOffset = intern(value);
+        node.valueLength = static_cast<uint32_t>(value.size());
+        node.firstChild = static_cast<uint32_t>(childIds.size());
+        node.childCount = static_cast<uint32_t>(openChildren.size() - mark);
+        childIds.insert(childIds.end(), openChildren.begin() + mark, openChildren.end());
+        openChildren.resize(mark);
+        nodes.push_back(node);
+        return static_cast<NodeId>(nodes.size() - 1);
+    }
+
+    NodeId makeLeaf(const string &value) {
+        return make(value, mark());
+    }
+
+    // Takes back the last node made, with its children's list, which is the
+    // last range of childIds. Nothing may refer to the node.
+    void removeLast() {
+        childIds.resize(nodes.back().firstChild);
+        nodes.pop_back();
+    }
+
+    string_view value(NodeId id) const {
+        return string_view(text).substr(nodes[id].valueOffset, nodes[id].valueLength);
+    }
+
+    size_t childCount(NodeId id) const {
+        return nodes[id].childCount;
+    }
+
+    NodeId child(NodeId id, size_t index) const {
+        return childIds[nodes[id].firstChild + index];
+    }
+
+    size_t size() const {
+        return nodes.size();
+    }
+
+    size_t bytesUsed() const {
+        return nodes.capacity() * sizeof(ASTNode) + childIds.capacity() * sizeof(NodeId) + text.capacity() +
+               textOffsets.size() * (sizeof(string) + sizeof(uint32_t) + sizeof(void *)) +
+               textOffsets.bucket_count() * sizeof(void *);
+    }
+
+    void clear() {
+        nodes.clear();
+        childIds.clear();
+        openChildren.clear();
+        text.clear();
+        textOffsets.clear();
+    }
+
+    // Drops every node `root` does not reach and renumbers the rest, keeping
+    // their order, so `root` is again the last node. Returns the new id of
+    // each old one, NO_NODE for those dropped. No node may be open.
+    vector<NodeId> keepReachable(NodeId root) {
+        vector<bool> reached(nodes.size(), false);
+        reached[root] = true;
+        for (NodeId id = root + 1; id-- > 0;) {  // Children are made before their parents
+            if (!reached[id]) continue;
+            for (size_t i = 0; i < nodes[id].childCount; i++) {
+                reached[child(id, i)] = true;
+            }
+        }
+        ASTArena kept;
+        vector<NodeId> renumbered(nodes.size(), NO_NODE);
+        for (NodeId id = 0; id <= root; id++) {
+            if (!reached[id]) continue;
+            size_t mark = kept.mark();
+            for (size_t i = 0; i < nodes[id].childCount; i++) {
+                kept.addChild(renumbered[child(id, i)]);
+            }
+            renumbered[id] = kept.make(string(value(id)), mark);
+        }
+        swap(*this, kept);
+        return renumbered;
+    }
+
+    // The tree is three flat arrays that only refer to each other by index,
+    // so it is saved and loaded as they are, with one read per array.
+    void save(ostream &out) const {
+        uint64_t sizes[3] = {nodes.size(), childIds.size(), text.size()};
+        out.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+        out.write(reinterpret_cast<const char *>(nodes.data()), nodes.size() * sizeof(ASTNode));
+        out.write(reinterpret_cast<const char *>(childIds.data()), childIds.size() * sizeof(NodeId));
+        out.write(text.data(), text.size());
+    }
+
+    // Replaces the tree with one written by save(). The loaded tree can be
+    // read but is not meant to be built on.
+    bool load(istream &in, uint64_t bytesLeft) {
+        clear();
+        uint64_t sizes[3];
+        if (!in.read(reinterpret_cast<char *>(sizes), sizeof(sizes)) ||
+            bytesLeft != sizeof(sizes) + sizes[0] * sizeof(ASTNode) + sizes[1] * sizeof(NodeId) + sizes[2]) {
+            return false;
+        }
+        nodes.resize(sizes[0]);
+        childIds.resize(sizes[1]);
+        text.resize(sizes[2]);
+        in.read(reinterpret_cast<char *>(nodes.data()), nodes.size() * sizeof(ASTNode));
+        in.read(reinterpret_cast<char *>(childIds.data()), childIds.size() * sizeof(NodeId));
+        in.read(&text[0], text.size());
+        if (!in || !isWellFormed()) {
+            clear();
+            return false;
+        }
+        return true;
+    }
+
+    // Whether every value and child list lies inside the arrays, and every
+    // child was made before its parent, as make() guarantees.
+    bool isWellFormed() const {
+        for (NodeId id = 0; id < nodes.size(); id++) {
+            const ASTNode &node = nodes[id];
+            if (uint64_t(node.valueOffset) + node.valueLength > text.size() ||
+                uint64_t(node.firstChild) + node.childCount > childIds.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < node.childCount; i++) {
+                if (childIds[node.firstChild + i] >= id) return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Trees of sources that parsed without errors are kept in AST_CACHE_DIRECTORY,
+// one file per source content, so an unchanged source skips lexing and
+// parsing. Bump AST_CACHE_VERSION whenever the tree the parser builds for a
+// given source changes.
+const char *const AST_CACHE_DIRECTORY = ".ast-cache";
+const uint32_t AST_CACHE_VERSION = 1;
+
+struct ASTCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint32_t root;
+    uint32_t reserved;
+};
+
+// 64-bit FNV-1a of the whole source
+uint64_t hashSource(const string &code) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : code) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Named by content and version, so entries of another version are never even opened
+string astCachePath(const string &code) {
+    char name[48];
+    snprintf(name, sizeof(name), "%016llx-v%u.ast", static_cast<unsigned long long>(hashSource(code)),
+             static_cast<unsigned>(AST_CACHE_VERSION));
+    return (filesystem::path(AST_CACHE_DIRECTORY) / name).string();
+}
+
+// Loads the cached tree of `code` into `arena` and returns its root, or
+// NO_NODE when there is none.
+NodeId loadCachedAST(const string &code, ASTArena &arena) {
+    ifstream in(astCachePath(code), ios::binary | ios::ate);
+    if (!in) {
+        return NO_NODE;
+    }
+    uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+    ASTCacheHeader header;
+    if (fileSize < sizeof(header) || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        string_view(header.magic, 4) != "HAST" || header.version != AST_CACHE_VERSION ||
+        header.sourceSize != code.size() || header.sourceHash != hashSource(code) ||
+        !arena.load(in, fileSize - sizeof(header)) || header.root >= arena.size()) {
+        arena.clear();
+        return NO_NODE;
+    }
+    return header.root;
+}
+
+// Written under a temporary name of its own and then moved into place, so a
+// reader never sees half a file and concurrent writers each leave a whole one.
+bool saveCachedAST(const string &code, const ASTArena &arena, NodeId root) {
+    error_code error;
+    filesystem::create_directories(AST_CACHE_DIRECTORY, error);
+    string path = astCachePath(code);
+    size_t unique = hash<thread::id>{}(this_thread::get_id()) ^
+                    static_cast<size_t>(chrono::steady_clock::now().time_since_epoch().count());
+    string temporaryPath = path + ".tmp" + to_string(unique);
+    {
+        ofstream out(temporaryPath, ios::binary | ios::trunc);
+        ASTCacheHeader header = {{'H', 'A', 'S', 'T'}, AST_CACHE_VERSION, hashSource(code), code.size(), root, 0};
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        arena.save(out);
+        if (!out.flush()) {
+            out.close();
+            remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    if (rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        remove(path.c_str());  // rename() does not replace an existing file everywhere
+        if (rename(temporaryPath.c_str(), path.c_str()) != 0) {
+            remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Adds a token's kind and value to a 64-bit FNV-1a hash
+uint64_t hashToken(uint64_t hash, const Token &token) {
+    hash = (hash ^ static_cast<uint8_t>(token.kind)) * 1099511628211ull;
+    if (token.name != NO_NAME) {
+        return (hash ^ token.name) * 1099511628211ull;  // The packed name is the whole spelling
+    }
+    hash = (hash ^ token.value.size()) * 1099511628211ull;
+    for (unsigned char c : token.value) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// The hash of tokens[begin, end)
+uint64_t hashTokens(const vector<Token> &tokens, size_t begin, size_t end) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = begin; i < end; i++) {
+        hash = hashToken(hash, tokens[i]);
+    }
+    return hash;
+}
+
+// Subtrees of top-level statements that parsed without errors, keyed by the
+// hash of their tokens. A statement ends on the ';' or '}' it consumes and
+// looks no further, so its subtree depends on its own tokens alone: wherever
+// the same tokens turn up again, say after an edit elsewhere in the source,
+// the subtree is reused as it is, and identical statements share one.
+// Nodes hold no positions, which is what makes that possible. The subtrees
+// live in the arena they were parsed into. Each entry keeps its tokens'
+// kinds and spellings, and a subtree is only reused when they match, so two
+// statements whose hashes collide are never mistaken for each other.
+//
+// An edit leaves most statements where they were relative to each other, so
+// the statements of the last parse are also kept in order and the next ones
+// there are tried first, by their tokens alone; where the statement ends and
+// its hash are only worked out, and the hash table asked, near an edit.
+struct StatementMemo {
+    struct Entry {
+        uint64_t key;
+        NodeId node;
+        uint32_t tokenCount;
+        // Each token's kind, then what else tells it apart: an identifier's
+        // packed name, or the length and text of an integer or unknown word.
+        // Keywords, operators and punctuation are spelled by their kind alone.
+        string spelling;
+
+        static bool hasText(TokenKind kind) {
+            return kind == TokenKind::INTEGER || kind == TokenKind::UNKNOWN;
+        }
+
+        static void spell(string &out, const Token &token) {
+            out += static_cast<char>(token.kind);
+            if (token.kind == TokenKind::IDENTIFIER) {
+                out.append(reinterpret_cast<const char *>(&token.name), sizeof(token.name));
+            } else if (hasText(token.kind)) {
+                auto length = static_cast<uint32_t>(token.value.size());
+                out.append(reinterpret_cast<const char *>(&length), sizeof(length));
+                out += token.value;
+            }
+        }
+
+        // Whether the statement's tokens start at tokens[begin]. As long as the
+        // kinds agree, the spelling is read exactly as spell() wrote it, so it
+        // is never read past its end.
+        bool matchesAt(const vector<Token> &tokens, size_t begin) const {
+            if (tokens.size() - begin < tokenCount) return false;
+            const char *at = spelling.data();
+            for (size_t i = begin; i < begin + tokenCount; i++) {
+                const Token &token = tokens[i];
+                if (*at++ != static_cast<char>(token.kind)) return false;
+                if (token.kind == TokenKind::IDENTIFIER) {
+                    Name name;
+                    memcpy(&name, at, sizeof(name));
+                    if (name != token.name) return false;
+                    at += sizeof(name);
+                } else if (hasText(token.kind)) {
+                    uint32_t length;
+                    memcpy(&length, at, sizeof(length));
+                    at += sizeof(length);
+                    if (length != token.value.size() || memcmp(at, token.value.data(), length) != 0) return false;
+                    at += length;
+                }
+            }
+            return true;
+        }
+    };
+
+    static const size_t LOOKAHEAD = 4;  // Statements an edit may have removed and still be caught in order
+
+    unordered_map<uint64_t, Entry> entries;  // Entries never move, so the lists below point into it
+    vector<const Entry *> order;              // The last parse's reusable statements, in source order
+    vector<const Entry *> nextOrder;          // Those of the parse under way
+    size_t reused = 0;                        // Statements of the last parse that came out of the memo
+    size_t parsed = 0;                        // and those that had to be parsed
+
+    // The next few statements of the last parse, from `cursor` on, tried
+    // against the tokens from tokens[begin]. The same tokens end the same
+    // statement, so this needs no statementEnd.
+    const Entry *findInOrder(const vector<Token> &tokens, size_t begin, size_t &cursor) const {
+        for (size_t i = cursor; i < order.size() && i < cursor + LOOKAHEAD; i++) {
+            if (order[i]->matchesAt(tokens, begin)) {
+                cursor = i + 1;
+                return order[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // The entry for the statement tokens[begin, end), whose hash is `key`, if there is one
+    const Entry *find(const vector<Token> &tokens, size_t begin, size_t end, uint64_t key) const {
+        auto found = entries.find(key);
+        return found != entries.end() && found->second.tokenCount == end - begin && found->second.matchesAt(tokens, begin)
+                   ? &found->second : nullptr;
+    }
+
+    // Records that tokens[begin, end), whose hash is `key`, parsed cleanly
+    // into `node`. A statement whose hash collides with another's replaces it.
+    const Entry *add(const vector<Token> &tokens, size_t begin, size_t end, uint64_t key, NodeId node) {
+        Entry &entry = entries[key];
+        entry.key = key;
+        entry.node = node;
+        entry.tokenCount = static_cast<uint32_t>(end - begin);
+        entry.spelling.clear();
+        for (size_t i = begin; i < end; i++) {
+            Entry::spell(entry.spelling, tokens[i]);
+        }
+        return &entry;
+    }
+
+    // Follows ASTArena::keepReachable: forgets the statements whose subtrees
+    // were dropped and renumbers the rest.
+    void renumber(const vector<NodeId> &renumbered) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (renumbered[it->second.node] == NO_NODE) {
+                it = entries.erase(it);
+            } else {
+                it->second.node = renumbered[it->second.node];
+                ++it;
+            }
+        }
+    }
 };
 
 class Parser {
 private:
-    vector<Token> tokens;
-    int currentIndex;
+    const vector<Token> &tokens;
+    size_t currentIndex;
     Token currentToken;
+    ASTArena &arena;
+    StatementMemo *memo;
+    size_t memoCursor = 0;  // Where in memo->order the next statement is looked for first
+    vector<string> diagnostics;
+    bool panicking = false;  // From a syntax error until synchronize() finds where to resume
 
     void advance() {
         if (currentIndex < tokens.size()) {
             currentToken = tokens[currentIndex++];
+        } else if (!tokens.empty()) {
+            // Out of tokens; point diagnostics just past the last one
+            const Token &last = tokens.back();
+            currentToken = {TokenKind::END_OF_INPUT, "", last.line, last.column + static_cast<int>(last.value.size()), NO_NAME};
+        } else {
+            currentToken = {TokenKind::END_OF_INPUT, "", 1, 1, NO_NAME};
         }
     }
 
-    bool match(const string &type) {
-        return currentToken.type == type;
+    bool match(TokenKind kind) {
+        return currentToken.kind == kind;
     }
 
+    // Records a syntax error unless an earlier one is still being recovered
+    // from; those that follow from it are not worth reporting.
     void expected(const string &expectedToken) {
-        cerr << "Syntax Error: Expected " << expectedToken << ", found '" << currentToken.value << "' at line " << currentToken.line << ", column " << currentToken.column << endl;
-        exit(1);
+        if (!panicking) {
+            string found = match(TokenKind::END_OF_INPUT) ? "end of input" : "'" + currentToken.value + "'";
+            diagnostics.push_back("Syntax Error: Expected " + expectedToken + ", found " + found + " at line " + to_string(currentToken.line) + ", column " + to_string(currentToken.column));
+        }
+        panicking = true;
     }
 
-    shared_ptr<ASTNode> parseExpr() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("Expr");
-        node->children.push_back(parseR());
-        node->children.push_back(parseExprPrime());
-        return node;
+    static bool startsState(TokenKind kind) {
+        switch (kind) {
+            case TokenKind::IF: case TokenKind::ITERATION: case TokenKind::PUT:
+            case TokenKind::READ: case TokenKind::PRINT:
+                return true;
+            default:
+                return false;
+        }
     }
 
-    shared_ptr<ASTNode> parseExprPrime() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("Expr'");
-        if (match("Operator") && (currentToken.value == "+" || currentToken.value == "-")) {
-            node->children.push_back(make_shared<ASTNode>(currentToken.value));
+    // Panic mode: skips to a token parsing can resume from, which is just past
+    // a ';' or at a statement keyword, 'Var', 'Start', 'End' or the '}' of an
+    // enclosing block. A block opened while skipping is skipped whole.
+    void synchronize() {
+        int depth = 0;
+        while (!match(TokenKind::END_OF_INPUT)) {
+            if (depth == 0 && (startsState(currentToken.kind) || match(TokenKind::VAR) || match(TokenKind::START) ||
+                               match(TokenKind::END) || match(TokenKind::RIGHT_BRACE))) {
+                break;
+            }
+            TokenKind skipped = currentToken.kind;
             advance();
-            node->children.push_back(parseR());
-            node->children.push_back(parseExprPrime());
+            if (skipped == TokenKind::LEFT_BRACE) {
+                depth++;
+            } else if (skipped == TokenKind::RIGHT_BRACE) {
+                if (--depth == 0) break;
+            } else if (skipped == TokenKind::SEMICOLON && depth == 0) {
+                break;
+            }
         }
-        return node;
+        panicking = false;
+    }
+
+    // Binding power of a binary operator inside an expression; higher binds
+    // tighter and 0 ends the expression. Comparisons are not expression
+    // operators: they only join the two sides of an If or Iteration condition.
+    static int binaryPower(TokenKind kind) {
+        switch (kind) {
+            case TokenKind::PLUS: case TokenKind::MINUS: return 1;
+            default: return 0;
+        }
+    }
+
+    static const int PREFIX_POWER = 2;  // Unary + and -, above every binary operator
+
+    struct PendingOperator {
+        string value;
+        int power;
+        int arity;  // 0 marks an open parenthesis
+    };
+
+    vector<PendingOperator> pendingOperators;  // Reused by every parseExpr
+    vector<NodeId> pendingOperands;
+
+    // Pops the top operator and the operands it takes into one node.
+    void reduce() {
+        PendingOperator op = pendingOperators.back();
+        pendingOperators.pop_back();
+        size_t mark = arena.mark();
+        size_t first = pendingOperands.size() - op.arity;
+        for (size_t i = first; i < pendingOperands.size(); i++) {
+            arena.addChild(pendingOperands[i]);
+        }
+        pendingOperands.resize(first);
+        pendingOperands.push_back(arena.make(op.value, mark));
     }
 
-    shared_ptr<ASTNode> parseStates() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("States");
-        node->children.push_back(parseState());
-        node->children.push_back(parseStatesPrime());
+    // Operator precedence (Pratt / shunting-yard) over explicit stacks:
+    // operands wait until the operator that takes them is reduced, so neither
+    // parentheses nor long chains recurse. Binary operators become a node with
+    // both sides as children, unary ones a node with one child.
+    NodeId parseExpr() {
+        size_t mark = arena.mark();
+        pendingOperators.clear();
+        pendingOperands.clear();
+        size_t openParens = 0;
+        bool expectOperand = true;
+        while (true) {
+            if (expectOperand) {
+                if (match(TokenKind::LEFT_PAREN)) {
+                    pendingOperators.push_back({"(", 0, 0});
+                    openParens++;
+                    advance();
+                } else if (match(TokenKind::PLUS) || match(TokenKind::MINUS)) {
+                    pendingOperators.push_back({currentToken.value, PREFIX_POWER, 1});
+                    advance();
+                } else {
+                    pendingOperands.push_back(parseR());
+                    expectOperand = false;
+                }
+                continue;
+            }
+            int power = binaryPower(currentToken.kind);
+            if (power != 0) {
+                // Left-associative: anything pending that binds at least as tightly goes first
+                while (!pendingOperators.empty() && pendingOperators.back().arity != 0 && pendingOperators.back().power >= power) {
+                    reduce();
+                }
+                pendingOperators.push_back({currentToken.value, power, 2});
+                advance();
+                expectOperand = true;
+            } else if (openParens > 0 && match(TokenKind::RIGHT_PAREN)) {
+                while (pendingOperators.back().arity != 0) {
+                    reduce();
+                }
+                pendingOperators.pop_back();
+                openParens--;
+                advance();
+            } else {
+                break;
+            }
+        }
+        if (openParens > 0) {
+            expected("')'");
+        }
+        // Parentheses left open by an error are dropped; only operators make nodes
+        while (!pendingOperators.empty()) {
+            if (pendingOperators.back().arity == 0) {
+                pendingOperators.pop_back();
+            } else {
+                reduce();
+            }
+        }
+        arena.addChild(pendingOperands.back());
+        return arena.make("Expr", mark);
+    }
+
+    // States ::= State States', States' ::= States | epsilon. Also a loop:
+    // the statements become the children of one States node, so the native
+    // stack does not grow with the length of the program. A token that
+    // cannot start a statement is reported and skipped.
+    NodeId parseStates() {
+        size_t mark = arena.mark();
+        do {
+            if (startsState(currentToken.kind)) {
+                arena.addChild(memo ? parseReusableState() : parseState());
+            } else {
+                expected("statement");
+                advance();
+                synchronize();
+            }
+        } while (!match(TokenKind::END_OF_INPUT));
+        return arena.make("States", mark);
+    }
+
+    // A statement that fails to parse still yields its partial node; the
+    // input is then skipped to where the next statement can start.
+    NodeId parseState() {
+        NodeId node;
+        switch (currentToken.kind) {
+            case TokenKind::IF: node = parseCondition("If"); break;
+            case TokenKind::ITERATION: node = parseCondition("Loop"); break;
+            case TokenKind::PUT: node = parseAssign(); break;
+            case TokenKind::READ: node = parseIn(); break;
+            case TokenKind::PRINT: node = parseOut(); break;
+            default: return NO_NODE;
+        }
+        if (panicking) {
+            synchronize();
+        }
         return node;
     }
 
-    shared_ptr<ASTNode> parseStatesPrime() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("States'");
-        if (match("Keyword") || match("Identifier")) {
-            node->children.push_back(parseStates());
+    // Where the statement starting at tokens[begin] ends, judged from the
+    // tokens alone: past the first ';' outside braces for Put, Read and
+    // Print, past the '}' closing the first '{' for If and Iteration. 0 when
+    // the tokens do not have that shape.
+    size_t statementEnd(size_t begin) const {
+        bool block = tokens[begin].kind == TokenKind::IF || tokens[begin].kind == TokenKind::ITERATION;
+        int depth = 0;
+        for (size_t i = begin; i < tokens.size(); i++) {
+            switch (tokens[i].kind) {
+                case TokenKind::LEFT_BRACE:
+                    depth++;
+                    break;
+                case TokenKind::RIGHT_BRACE:
+                    if (--depth < 0 || !block) return 0;
+                    if (depth == 0) return i + 1;
+                    break;
+                case TokenKind::SEMICOLON:
+                    if (depth == 0) return block ? 0 : i + 1;
+                    break;
+                default:
+                    break;
+            }
+        }
+        return 0;
+    }
+
+    // parseState, but a statement whose tokens the memo has seen parse
+    // cleanly is skipped and its subtree reused.
+    NodeId parseReusableState() {
+        size_t begin = currentIndex - 1;
+        const StatementMemo::Entry *entry = memo->findInOrder(tokens, begin, memoCursor);
+        size_t end = entry ? begin + entry->tokenCount : statementEnd(begin);
+        uint64_t key = 0;
+        if (!entry && end != 0) {
+            key = hashTokens(tokens, begin, end);
+            entry = memo->find(tokens, begin, end, key);
         }
+        if (entry) {
+            memo->nextOrder.push_back(entry);
+            memo->reused++;
+            currentIndex = end;
+            advance();
+            return entry->node;
+        }
+        size_t errors = diagnostics.size();
+        NodeId node = parseState();
+        size_t consumed = match(TokenKind::END_OF_INPUT) ? tokens.size() : currentIndex - 1;
+        if (end != 0 && consumed == end && diagnostics.size() == errors) {
+            memo->nextOrder.push_back(memo->add(tokens, begin, end, key, node));
+        }
+        memo->parsed++;
         return node;
     }
 
-    shared_ptr<ASTNode> parseR() {
-        shared_ptr<ASTNode> node = make_shared<ASTNode>("R");
-        if (match("Identifier") || match("Integer")) {
-            node->children.push_back(make_shared<ASTNode>(currentToken.value));
+    // Consumes the expected token; a missing one is reported, not skipped over.
+    void expect(TokenKind kind, const string &expectedToken) {
+        if (match(kind)) {
             advance();
         } else {
-            expected("Identifier or Integer");
+            expected(expectedToken);
         }
-        return node;
+    }
+
+    // If and Iteration share their shape: keyword ( Expr op Expr ) { State }
+    NodeId parseCondition(const string &name) {
+        size_t mark = arena.mark();
+        advance();
+        expect(TokenKind::LEFT_PAREN, "'('");
+        arena.addChild(parseExpr());
+        if (isOperator(currentToken.kind)) {
+            arena.addChild(arena.makeLeaf(currentToken.value));
+            advance();
+        } else {
+            expected("operator");
+        }
+        arena.addChild(parseExpr());
+        expect(TokenKind::RIGHT_PAREN, "')'");
+        expect(TokenKind::LEFT_BRACE, "'{'");
+        arena.addChild(parseState());
+        expect(TokenKind::RIGHT_BRACE, "'}'");
+        return arena.make(name, mark);
+    }
+
+    NodeId parseAssign() {
+        size_t mark = arena.mark();
+        advance();
+        if (match(TokenKind::IDENTIFIER)) {
+            arena.addChild(arena.makeLeaf(currentToken.value));
+            advance();
+        } else {
+            expected("Identifier");
+        }
+        expect(TokenKind::ASSIGN, "'='");
+        arena.addChild(parseExpr());
+        expect(TokenKind::SEMICOLON, "';'");
+        return arena.make("Assign", mark);
+    }
+
+    NodeId parseIn() {
+        size_t mark = arena.mark();
+        advance();
+        expect(TokenKind::LEFT_PAREN, "'('");
+        if (match(TokenKind::IDENTIFIER)) {
+            arena.addChild(arena.makeLeaf(currentToken.value));
+            advance();
+        } else {
+            expected("Identifier");
+        }
+        expect(TokenKind::RIGHT_PAREN, "')'");
+        expect(TokenKind::SEMICOLON, "';'");
+        return arena.make("In", mark);
+    }
+
+    NodeId parseOut() {
+        size_t mark = arena.mark();
+        advance();
+        expect(TokenKind::LEFT_PAREN, "'('");
+        arena.addChild(parseExpr());
+        expect(TokenKind::RIGHT_PAREN, "')'");
+        expect(TokenKind::SEMICOLON, "';'");
+        return arena.make("Out", mark);
+    }
+
+    NodeId parseR() {
+        size_t mark = arena.mark();
+        if (match(TokenKind::IDENTIFIER) || match(TokenKind::INTEGER)) {
+            arena.addChild(arena.makeLeaf(currentToken.value));
+            advance();
+        } else {
+            expected("Identifier, Integer or '('");
+        }
+        return arena.make("R", mark);
     }
 
 public:
-    Parser(const vector<Token> &tokens) : tokens(tokens), currentIndex(0) {
+    // With a memo, top-level statements seen before are reused from it and
+    // new ones that parse cleanly are added to it; `arena` must then be the
+    // one the memo's subtrees were parsed into.
+    Parser(const vector<Token> &tokens, ASTArena &arena, StatementMemo *memo = nullptr)
+        : tokens(tokens), currentIndex(0), arena(arena), memo(memo) {
         advance();
     }
 
-    shared_ptr<ASTNode> parse() {
+    // Builds the tree into the arena and returns its root.
+    NodeId parse() {
         return parseStates();
     }
+
+    // Every error parse() found, in source order
+    const vector<string> &getDiagnostics() const {
+        return diagnostics;
+    }
+};
+
+// Parses successive versions of one source, as an editor would after each
+// edit, reparsing only the top-level statements whose tokens changed. The
+// arena and memo persist across parses; each parse replaces the old States
+// root, while the subtrees of edited statements stay behind in the arena,
+// where an undo can still find them. Once the arena has grown to twice its
+// size after the last compaction, everything the current tree does not
+// reach is dropped from the arena and the memo, so both stay within a
+// constant factor of the live tree however long the editing goes on.
+class IncrementalParser {
+private:
+    static const size_t MIN_COMPACT_NODES = 4096;  // Small trees are not worth compacting
+
+    ASTArena arena;
+    StatementMemo memo;
+    NodeId root = NO_NODE;
+    size_t compactedSize = 0;  // Arena size after the first parse or the last compaction
+    vector<string> diagnostics;
+
+public:
+    NodeId parse(const vector<Token> &tokens) {
+        if (root != NO_NODE) {
+            arena.removeLast();  // The old root is always the last node made
+        }
+        memo.reused = 0;
+        memo.parsed = 0;
+        memo.nextOrder.clear();
+        Parser parser(tokens, arena, &memo);
+        bool first = root == NO_NODE;
+        root = parser.parse();
+        swap(memo.order, memo.nextOrder);
+        diagnostics = parser.getDiagnostics();
+        if (first) {
+            compactedSize = arena.size();
+        } else if (arena.size() >= 2 * compactedSize && arena.size() >= MIN_COMPACT_NODES) {
+            // Every entry in memo.order is in the tree just built, so none is dropped
+            vector<NodeId> renumbered = arena.keepReachable(root);
+            memo.renumber(renumbered);
+            root = renumbered[root];
+            compactedSize = arena.size();
+        }
+        return root;
+    }
+
+    const ASTArena &getArena() const {
+        return arena;
+    }
+
+    const StatementMemo &getMemo() const {
+        return memo;
+    }
+
+    const vector<string> &getDiagnostics() const {
+        return diagnostics;
+    }
 };
 
 int main() {
@@ -171,13 +1119,30 @@ int main() {
     }
     inputFile.close();
 
+    ASTArena arena;
+    if (loadCachedAST(code, arena) != NO_NODE) {
+        cout << "Parsing completed successfully!" << endl;
+        return 0;
+    }
+
     LexicalAnalyzer lexicalAnalyzer;
     lexicalAnalyzer.analyze(code);
     const vector<Token> &tokens = lexicalAnalyzer.getTokens();
 
-    Parser parser(tokens);
-    shared_ptr<ASTNode> ast = parser.parse();
+    Parser parser(tokens, arena);
+    NodeId root = parser.parse();
 
+    const vector<string> &diagnostics = parser.getDiagnostics();
+    for (const string &diagnostic : diagnostics) {
+        cerr << diagnostic << endl;
+    }
+    if (!diagnostics.empty()) {
+        cout << "Parsing failed with " << diagnostics.size() << " error(s)." << endl;
+        return 1;
+    }
+    if (!saveCachedAST(code, arena, root)) {
+        cerr << "Warning: Could not write to " << AST_CACHE_DIRECTORY << endl;
+    }
     cout << "Parsing completed successfully!" << endl;
 
     return 0;
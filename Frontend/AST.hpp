@@ -0,0 +1,149 @@
+#ifndef AST_HPP
+#define AST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class AstKind : std::uint8_t {
+    Program,     // Token: END. Children: every declaration
+    VarDec,      // Token: the type keyword. Children: Identifier [, initializer]
+    Identifier,
+    Number,
+    Unary,       // Token: the operator. Child: the operand
+    Binary,      // Token: the operator. Children: left and right operands
+    Error,       // Token: where the syntax error was found. Children: what parsed before it
+};
+
+inline const char* getAstKindName(AstKind kind) {
+    switch (kind) {
+        case AstKind::Program: return "Program";
+        case AstKind::VarDec: return "VarDec";
+        case AstKind::Identifier: return "Identifier";
+        case AstKind::Number: return "Number";
+        case AstKind::Unary: return "Unary";
+        case AstKind::Binary: return "Binary";
+        case AstKind::Error: return "Error";
+        default: return "Unknown";
+    }
+}
+
+using AstIndex = std::uint32_t;
+
+// One node of the tree. `token` is the position of the node's token in the
+// token stream, which is also its index in a materialized token vector.
+struct AstNode {
+    AstKind kind;
+    std::uint32_t token;
+    std::uint32_t childCount;
+    std::uint32_t span;  // Nodes in this subtree, the node itself included
+};
+
+static_assert(sizeof(AstNode) == 16, "AST nodes are meant to stay compact");
+
+// Read access to a syntax tree flattened into one array in post-order: every
+// subtree is the contiguous run of `span` nodes that ends at its root, a
+// node's last child sits right before it, and the root is the last node.
+// Passes walk the array front to back, visiting children before parents,
+// without chasing pointers. The nodes may live in an Ast or in a mapped
+// cache file; nothing in them depends on where they are.
+class AstView {
+public:
+    AstView() = default;
+
+    AstView(const AstNode* nodes, std::size_t count) : nodes(nodes), count(count) {}
+
+    [[nodiscard]] const AstNode& operator[](AstIndex index) const {
+        return nodes[index];
+    }
+
+    [[nodiscard]] const AstNode* data() const {
+        return nodes;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return count;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return count == 0;
+    }
+
+    [[nodiscard]] AstIndex root() const {
+        return static_cast<AstIndex>(count - 1);
+    }
+
+    // The subtree of `index` is [firstNode(index), index]
+    [[nodiscard]] AstIndex firstNode(AstIndex index) const {
+        return index + 1 - nodes[index].span;
+    }
+
+    // Children are visited last to first: lastChild, then previousSibling
+    // until childCount of them have been seen.
+    [[nodiscard]] static AstIndex lastChild(AstIndex index) {
+        return index - 1;
+    }
+
+    [[nodiscard]] AstIndex previousSibling(AstIndex index) const {
+        return index - nodes[index].span;
+    }
+
+private:
+    const AstNode* nodes = nullptr;
+    std::size_t count = 0;
+};
+
+// Builds a tree in post-order into a single vector.
+class Ast {
+public:
+    [[nodiscard]] AstView view() const {
+        return {entries.data(), entries.size()};
+    }
+
+    [[nodiscard]] const std::vector<AstNode>& nodes() const {
+        return entries;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return entries.size();
+    }
+
+    // Where the next node will go; pass it to add() to make every node added
+    // from here on a descendant of that node.
+    [[nodiscard]] std::size_t mark() const {
+        return entries.size();
+    }
+
+    // Appends a node whose children are the subtrees added since `from`.
+    AstIndex add(AstKind kind, std::size_t token, std::size_t from) {
+        std::uint32_t children = 0;
+        for (std::size_t child = entries.size(); child > from; child -= entries[child - 1].span) {
+            children++;
+        }
+        auto span = static_cast<std::uint32_t>(entries.size() - from + 1);
+        AstNode node{};  // Zeroed padding keeps cache files byte-for-byte reproducible
+        node.kind = kind;
+        node.token = static_cast<std::uint32_t>(token);
+        node.childCount = children;
+        node.span = span;
+        entries.push_back(node);
+        return static_cast<AstIndex>(entries.size() - 1);
+    }
+
+    void reserve(std::size_t nodeCount) {
+        entries.reserve(nodeCount);
+    }
+
+    void clear() {
+        entries.clear();
+    }
+
+    [[nodiscard]] std::size_t bytesUsed() const {
+        return entries.capacity() * sizeof(AstNode);
+    }
+
+private:
+    std::vector<AstNode> entries;
+};
+
+#endif // AST_HPP
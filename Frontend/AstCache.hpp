@@ -0,0 +1,153 @@
+#ifndef ASTCACHE_HPP
+#define ASTCACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "AST.hpp"
+#include "SourceBuffer.hpp"
+#include "Token.hpp"
+#include "TokenCache.hpp"
+
+// An AST cache is a directory of entries, one per source content and front
+// end version, each holding the tree of a source that parsed without errors
+// and the tokens its nodes refer to:
+//
+//   header | AstNode[nodeCount] | TokenRecord[tokenCount]
+//
+// Nodes refer to each other and to tokens by index only, so an entry is used
+// straight from the mapped file. Bump the version whenever the node layout or
+// what the front end produces for a given source changes; entries of other
+// versions are then simply never looked up.
+constexpr char AST_CACHE_MAGIC[8] = {'H', 'U', 'T', 'A', 'S', 'T', '\r', '\n'};
+constexpr std::uint32_t AST_CACHE_VERSION = 1;
+
+struct AstCacheHeader {
+    char magic[8];
+    std::uint32_t version;       // Also reads wrong on a machine of the other byte order
+    std::uint32_t tokenVersion;  // TOKEN_CACHE_VERSION of the token records
+    std::uint64_t sourceHash;
+    std::uint64_t sourceSize;
+    std::uint64_t nodeCount;
+    std::uint64_t tokenCount;
+};
+
+static_assert(sizeof(AstCacheHeader) == 48, "the header layout is part of the format");
+static_assert(sizeof(AstCacheHeader) % alignof(AstNode) == 0, "nodes are read in place after the header");
+
+// The entry for `source` in the cache at `directory`
+inline std::string astCachePath(const std::string& directory, std::string_view source) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "%016llx-v%u.ast", static_cast<unsigned long long>(hashSource(source)),
+                  static_cast<unsigned>(AST_CACHE_VERSION));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+// Stores the tree of `source` and the tokens it was parsed from, creating
+// the cache directory if needed.
+inline bool writeAstCache(const std::string& directory, std::string_view source, AstView ast,
+                          const std::vector<Token>& tokens) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) return false;
+
+    AstCacheHeader header{};
+    std::memcpy(header.magic, AST_CACHE_MAGIC, sizeof(header.magic));
+    header.version = AST_CACHE_VERSION;
+    header.tokenVersion = TOKEN_CACHE_VERSION;
+    header.sourceHash = hashSource(source);
+    header.sourceSize = source.size();
+    header.nodeCount = ast.size();
+    header.tokenCount = tokens.size();
+
+    std::vector<TokenRecord> records = makeTokenRecords(tokens);
+    return replaceFile(astCachePath(directory, source),
+                       {{reinterpret_cast<const char*>(&header), sizeof(header)},
+                        {reinterpret_cast<const char*>(ast.data()), ast.size() * sizeof(AstNode)},
+                        {reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TokenRecord)}});
+}
+
+// A cache entry mapped into memory. The tree is read in place, so loading
+// costs one mapping however large the tree is.
+class CachedAst {
+public:
+    // Maps the entry for `source`. Fails when there is none, or when it is
+    // malformed or was written for a different source that hashed the same.
+    // Every node is checked before the tree is handed out, so a damaged body
+    // makes the caller parse as if there were no entry.
+    bool open(const std::string& directory, std::string_view source) {
+        ast = {};
+        // Not held to the source limit: the tokens and nodes of one can outgrow it
+        if (!file.open(astCachePath(directory, source), SIZE_MAX) || file.size() < sizeof(AstCacheHeader)) return false;
+
+        AstCacheHeader header{};
+        std::memcpy(&header, file.data(), sizeof(header));
+        std::uint64_t bodySize = file.size() - sizeof(header);
+        if (std::memcmp(header.magic, AST_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != AST_CACHE_VERSION || header.tokenVersion != TOKEN_CACHE_VERSION ||
+            header.sourceSize != source.size() || header.nodeCount == 0 ||
+            header.nodeCount > bodySize / sizeof(AstNode) ||
+            header.tokenCount != (bodySize - header.nodeCount * sizeof(AstNode)) / sizeof(TokenRecord) ||
+            header.sourceHash != hashSource(source)) {
+            return false;
+        }
+
+        const char* body = file.data() + sizeof(header);
+        AstView nodes(reinterpret_cast<const AstNode*>(body), static_cast<std::size_t>(header.nodeCount));
+        if (!isWellFormed(nodes, header.tokenCount)) return false;
+        ast = nodes;
+        tokenRecords = body + header.nodeCount * sizeof(AstNode);
+        tokenCount = static_cast<std::size_t>(header.tokenCount);
+        this->source = source;
+        return true;
+    }
+
+    [[nodiscard]] AstView view() const {
+        return ast;
+    }
+
+    // The tokens the nodes refer to, decoded as they are pulled
+    void replayTokens(CachedTokenSource& tokens) const {
+        tokens.replay(tokenRecords, tokenCount, source);
+    }
+
+    [[nodiscard]] std::size_t tokenSize() const {
+        return tokenCount;
+    }
+
+private:
+    SourceBuffer file;
+
+    // Whether `ast` is a post-order tree that AstView can walk without
+    // leaving it: each node's children tile exactly the span before it, and
+    // the root spans every node. A node's token is at most `tokenCount`,
+    // which is the END position the Program node refers to.
+    static bool isWellFormed(AstView ast, std::uint64_t tokenCount) {
+        for (AstIndex index = 0; index < ast.size(); index++) {
+            const AstNode& node = ast[index];
+            if (node.kind > AstKind::Error || node.token > tokenCount || node.span == 0 || node.span > index + 1) {
+                return false;
+            }
+            // Children are checked before their parents, so their spans can be trusted here
+            std::uint32_t covered = 1;
+            for (std::uint32_t i = 0; i < node.childCount; i++) {
+                if (covered >= node.span) return false;
+                covered += ast[index - covered].span;
+            }
+            if (covered != node.span) return false;
+        }
+        return ast[ast.root()].span == ast.size();
+    }
+    AstView ast;
+    const char* tokenRecords = nullptr;
+    std::size_t tokenCount = 0;
+    std::string_view source;
+};
+
+#endif // ASTCACHE_HPP
@@ -0,0 +1,153 @@
+#ifndef BATCHCOMPILER_HPP
+#define BATCHCOMPILER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "AST.hpp"
+#include "AstCache.hpp"
+#include "Diagnostics.hpp"
+#include "Parser.hpp"
+#include "Scanner.hpp"
+#include "SourceBuffer.hpp"
+#include "TokenCache.hpp"
+#include "TokenStream.hpp"
+#include "WorkStealingPool.hpp"
+
+struct CompileOptions {
+    std::string astCacheDirectory;  // Empty for no AST cache
+};
+
+struct CompileResult {
+    bool opened = false;
+    std::string error;  // Why it was not opened, as SourceBuffer::getError says
+    bool cached = false;  // Came out of the AST cache without lexing or parsing
+    std::size_t bytes = 0;
+    Diagnostics diagnostics;
+};
+
+// What one thread keeps from file to file so that compiling the next one
+// reuses memory instead of allocating it again.
+struct CompileWorkspace {
+    Ast ast;
+    std::vector<Token> tokens;
+    Interner* interner = &Interner::global();  // Where the file's names and literals go
+};
+
+// Runs the front end over one file: from the AST cache when it holds the
+// tree, otherwise from the file's token cache or the scanner into the parser.
+inline CompileResult compileFile(const std::string& path, const CompileOptions& options, CompileWorkspace& workspace) {
+    CompileResult result;
+    SourceBuffer source;
+    if (!source.open(path)) {
+        result.error = source.getError();
+        return result;
+    }
+    result.opened = true;
+    result.bytes = source.size();
+
+    bool useAstCache = !options.astCacheDirectory.empty();
+    if (useAstCache) {
+        CachedAst cachedAst;
+        if (cachedAst.open(options.astCacheDirectory, source.view())) {
+            result.cached = true;
+            return result;
+        }
+    }
+
+    Scanner scanner(source.view());
+    CachedTokenSource cachedTokens;
+    scanner.setInterner(*workspace.interner);
+    cachedTokens.setInterner(*workspace.interner);
+    TokenSource* tokenSource = &scanner;
+    if (cachedTokens.open(tokenCachePath(path), source.view())) {
+        tokenSource = &cachedTokens;
+    }
+    // The AST cache stores the tokens as well, so then they are kept
+    VectorTokenSource keptTokens(workspace.tokens);
+    if (useAstCache) {
+        workspace.tokens.clear();
+        for (Token token; tokenSource->nextToken(token);) {
+            workspace.tokens.push_back(token);
+        }
+        tokenSource = &keptTokens;
+    }
+
+    TokenStream tokenStream(*tokenSource);
+    Parser parser(tokenStream, source.view(), std::move(workspace.ast));
+    if (parser.Parse() && useAstCache) {
+        writeAstCache(options.astCacheDirectory, source.view(), parser.getAst().view(), workspace.tokens);
+    }
+    result.diagnostics = parser.getDiagnostics();
+    workspace.ast = parser.takeAst();
+    return result;
+}
+
+// Compiles many files in one process on a work-stealing pool. The lexer and
+// parser tables are compile-time constants and the interner is shared, so
+// threads share everything immutable and each keeps its own workspace.
+// Results come back in input order, whatever order the files finished in.
+class BatchCompiler {
+public:
+    explicit BatchCompiler(unsigned threadCount = std::thread::hardware_concurrency(), CompileOptions options = {})
+        : pool(threadCount), options(std::move(options)) {}
+
+    std::vector<CompileResult> compile(const std::vector<std::string>& paths) const {
+        std::vector<CompileResult> results(paths.size());
+        std::vector<CompileWorkspace> workspaces(pool.getThreadCount());
+        pool.run(paths.size(), [&](std::size_t file, std::size_t worker) {
+            results[file] = compileFile(paths[file], options, workspaces[worker]);
+        });
+        return results;
+    }
+
+    [[nodiscard]] unsigned getThreadCount() const {
+        return pool.getThreadCount();
+    }
+
+private:
+    WorkStealingPool pool;
+    CompileOptions options;
+};
+
+// Turns command-line inputs into the files to compile: a directory stands
+// for every .hol file below it, in path order, and "@list" for the paths
+// listed one per line in the file `list`. Inputs that cannot be expanded are
+// passed through, so opening them reports the error.
+inline std::vector<std::string> expandInputs(const std::vector<std::string>& inputs) {
+    std::vector<std::string> paths;
+    for (const std::string& input : inputs) {
+        std::error_code error;
+        if (input.size() > 1 && input[0] == '@') {
+            std::ifstream list(input.substr(1));
+            if (!list) {
+                paths.push_back(input);
+                continue;
+            }
+            for (std::string line; std::getline(list, line);) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (!line.empty()) paths.push_back(line);
+            }
+        } else if (std::filesystem::is_directory(input, error)) {
+            std::vector<std::string> found;
+            for (std::filesystem::recursive_directory_iterator it(input, error), end; !error && it != end;
+                 it.increment(error)) {
+                if (it->is_regular_file(error) && it->path().extension() == ".hol") {
+                    found.push_back(it->path().string());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            paths.insert(paths.end(), found.begin(), found.end());
+        } else {
+            paths.push_back(input);
+        }
+    }
+    return paths;
+}
+
+#endif // BATCHCOMPILER_HPP
@@ -0,0 +1,172 @@
+#ifndef BYTECLASSIFIER_HPP
+#define BYTECLASSIFIER_HPP
+
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define HUT_HAS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// Byte runs the scanner can skip over in bulk. Inside each of them the DFA
+// stays in the same state, so only the byte that ends the run needs a real
+// transition.
+enum class ByteRun {
+    BLANK,   // [ \t\v\f\r]; newlines are left to the scanner for line counting
+    LETTER,  // [a-zA-Z_]
+    DIGIT,   // [0-9], continues a number
+    WORD     // [a-zA-Z0-9_], continues an identifier
+};
+
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// Finds where a run of one byte class ends, 16 or 32 bytes at a time when the
+// CPU allows it. The implementation is picked once at startup from the CPU's
+// features; setLevel can force a lower one, e.g. to compare against scalar.
+class ByteClassifier {
+public:
+    // The first byte in [cursor, end) that is not part of `run`, or `end`.
+    static const char* skipRun(ByteRun run, const char* cursor, const char* end) {
+        // Most runs in real code are a byte or two long; settle those without a vector load
+        if (cursor == end || !inRun(run, *cursor)) return cursor;
+        if (end - cursor < 2 || !inRun(run, cursor[1])) return cursor + 1;
+        switch (activeLevel()) {
+#ifdef HUT_HAS_X86_SIMD
+            case SimdLevel::AVX2: return skipRunAvx2(run, cursor, end);
+            case SimdLevel::SSE2: return skipRunSse2(run, cursor, end);
+#endif
+            default: return skipRunScalar(run, cursor, end);
+        }
+    }
+
+    static SimdLevel detect() {
+#ifdef HUT_HAS_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        return SimdLevel::SSE2;
+#else
+        return SimdLevel::SCALAR;
+#endif
+    }
+
+    static SimdLevel level() {
+        return activeLevel();
+    }
+
+    // Selects `requested`, or the best level the CPU supports if that is lower.
+    static void setLevel(SimdLevel requested) {
+        SimdLevel supported = detect();
+        activeLevel() = static_cast<int>(requested) < static_cast<int>(supported) ? requested : supported;
+    }
+
+    static bool inRun(ByteRun run, char ch) {
+        auto byte = static_cast<unsigned char>(ch);
+        switch (run) {
+            case ByteRun::BLANK: return byte == ' ' || byte == '\t' || byte == '\v' || byte == '\f' || byte == '\r';
+            case ByteRun::LETTER: return static_cast<unsigned char>((byte | 0x20) - 'a') <= 'z' - 'a' || byte == '_';
+            case ByteRun::DIGIT: return static_cast<unsigned char>(byte - '0') <= 9;
+            case ByteRun::WORD: return inRun(ByteRun::LETTER, ch) || inRun(ByteRun::DIGIT, ch);
+        }
+        return false;
+    }
+
+private:
+    static SimdLevel& activeLevel() {
+        static SimdLevel current = detect();
+        return current;
+    }
+
+    static const char* skipRunScalar(ByteRun run, const char* cursor, const char* end) {
+        while (cursor != end && inRun(run, *cursor)) {
+            ++cursor;
+        }
+        return cursor;
+    }
+
+#ifdef HUT_HAS_X86_SIMD
+    // Bit i of the result is set when byte i of `bytes` belongs to `run`.
+    // Ranges are tested as (byte - low) <= (high - low) on unsigned bytes,
+    // using min_epu8 because SSE2 has no unsigned byte comparison.
+    static unsigned runMaskSse2(ByteRun run, __m128i bytes) {
+        __m128i inClass;
+        switch (run) {
+            case ByteRun::BLANK: {
+                __m128i controls = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+                __m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(controls, _mm_set1_epi8('\r' - '\t')), controls);
+                __m128i isNewline = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n'));
+                inClass = _mm_or_si128(_mm_andnot_si128(isNewline, isControl), _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')));
+                break;
+            }
+            case ByteRun::LETTER: {
+                __m128i folded = _mm_sub_epi8(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+                __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(folded, _mm_set1_epi8('z' - 'a')), folded);
+                inClass = _mm_or_si128(isLetter, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_')));
+                break;
+            }
+            case ByteRun::WORD:
+                return runMaskSse2(ByteRun::LETTER, bytes) | runMaskSse2(ByteRun::DIGIT, bytes);
+            default: {
+                __m128i digits = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+                inClass = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+                break;
+            }
+        }
+        return static_cast<unsigned>(_mm_movemask_epi8(inClass));
+    }
+
+    static const char* skipRunSse2(ByteRun run, const char* cursor, const char* end) {
+        while (end - cursor >= 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+            unsigned outside = ~runMaskSse2(run, bytes) & 0xFFFFu;
+            if (outside) return cursor + __builtin_ctz(outside);
+            cursor += 16;
+        }
+        return skipRunScalar(run, cursor, end);
+    }
+
+    __attribute__((target("avx2")))
+    static unsigned runMaskAvx2(ByteRun run, __m256i bytes) {
+        __m256i inClass;
+        switch (run) {
+            case ByteRun::BLANK: {
+                __m256i controls = _mm256_sub_epi8(bytes, _mm256_set1_epi8('\t'));
+                __m256i isControl = _mm256_cmpeq_epi8(_mm256_min_epu8(controls, _mm256_set1_epi8('\r' - '\t')), controls);
+                __m256i isNewline = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'));
+                inClass = _mm256_or_si256(_mm256_andnot_si256(isNewline, isControl), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')));
+                break;
+            }
+            case ByteRun::LETTER: {
+                __m256i folded = _mm256_sub_epi8(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+                __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(folded, _mm256_set1_epi8('z' - 'a')), folded);
+                inClass = _mm256_or_si256(isLetter, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_')));
+                break;
+            }
+            case ByteRun::WORD:
+                return runMaskAvx2(ByteRun::LETTER, bytes) | runMaskAvx2(ByteRun::DIGIT, bytes);
+            default: {
+                __m256i digits = _mm256_sub_epi8(bytes, _mm256_set1_epi8('0'));
+                inClass = _mm256_cmpeq_epi8(_mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+                break;
+            }
+        }
+        return static_cast<unsigned>(_mm256_movemask_epi8(inClass));
+    }
+
+    __attribute__((target("avx2")))
+    static const char* skipRunAvx2(ByteRun run, const char* cursor, const char* end) {
+        while (end - cursor >= 32) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cursor));
+            unsigned outside = ~runMaskAvx2(run, bytes);
+            if (outside) return cursor + __builtin_ctz(outside);
+            cursor += 32;
+        }
+        return skipRunSse2(run, cursor, end);
+    }
+#endif
+};
+
+#endif // BYTECLASSIFIER_HPP
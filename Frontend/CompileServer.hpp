@@ -0,0 +1,440 @@
+#ifndef COMPILESERVER_HPP
+#define COMPILESERVER_HPP
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "BatchCompiler.hpp"
+
+// The wire protocol is one line per request and per reply line, so it can be
+// driven by hand with `nc -U`:
+//
+//   COMPILE <path>  the diagnostics, one per line, then "OK <errors> <microseconds>"
+//                   or "ERROR <message>"
+//   STATS           "STATS <requests> <p50> <p90> <p99> <max>", latencies in microseconds
+//   SHUTDOWN        "BYE"; the server finishes the requests being compiled, drops
+//                   the ones still queued, closes every connection and exits
+//
+// Paths are resolved by the server, so clients send absolute ones.
+
+// Writes all of `text` to `fd`. False if the peer is gone or stopped reading.
+inline bool writeAll(int fd, std::string_view text) {
+    while (!text.empty()) {
+        ssize_t written = ::write(fd, text.data(), text.size());
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        text.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+// A connected socket read line by line and written in whole lines.
+class LineChannel {
+public:
+    explicit LineChannel(int fd) : fd(fd) {}
+
+    LineChannel(const LineChannel&) = delete;
+    LineChannel& operator=(const LineChannel&) = delete;
+
+    ~LineChannel() {
+        ::close(fd);
+    }
+
+    // Reads up to the next '\n', which is dropped. False at end of stream.
+    bool readLine(std::string& line) {
+        while (true) {
+            std::size_t newline = pending.find('\n');
+            if (newline != std::string::npos) {
+                line.assign(pending, 0, newline);
+                pending.erase(0, newline + 1);
+                return true;
+            }
+            char chunk[4096];
+            ssize_t bytesRead = ::read(fd, chunk, sizeof(chunk));
+            if (bytesRead < 0 && errno == EINTR) continue;
+            if (bytesRead <= 0) return false;
+            pending.append(chunk, static_cast<std::size_t>(bytesRead));
+        }
+    }
+
+    bool write(std::string_view text) {
+        return writeAll(fd, text);
+    }
+
+private:
+    int fd;
+    std::string pending;
+};
+
+inline bool makeSocketAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Per-request latencies, for percentiles over the life of the server.
+class LatencyLog {
+public:
+    void record(std::uint64_t microseconds) {
+        std::lock_guard<std::mutex> lock(mutex);
+        samples.push_back(microseconds);
+    }
+
+    // "<requests> <p50> <p90> <p99> <max>", nearest-rank percentiles
+    [[nodiscard]] std::string summary() const {
+        std::vector<std::uint64_t> sorted;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sorted = samples;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](std::size_t p) -> std::uint64_t {
+            if (sorted.empty()) return 0;
+            std::size_t rank = (p * sorted.size() + 99) / 100;
+            return sorted[std::max<std::size_t>(rank, 1) - 1];
+        };
+        std::ostringstream out;
+        out << sorted.size() << ' ' << percentile(50) << ' ' << percentile(90) << ' ' << percentile(99) << ' '
+            << (sorted.empty() ? 0 : sorted.back());
+        return out.str();
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<std::uint64_t> samples;
+};
+
+// A long-lived compiler listening on a Unix domain socket. Everything that is
+// expensive to set up stays warm between requests: each worker's AST, token
+// storage and interner, and the page cache behind the AST cache.
+//
+// One thread polls the listener and every idle connection and splits what
+// arrives into lines. Each request is queued to a fixed set of workers on
+// its own, so a client that connects and sends nothing costs a pollfd, not
+// a worker. A connection has at most one request out at a time, which keeps
+// its replies in order; the rest of its lines wait in its buffer. Workers
+// write every reply, so a client that stops reading can hold up a worker
+// but never the polling thread. The one exception is BYE, which the polling
+// thread sends without waiting before it stops. A user error such as a
+// missing file or a syntax error is only ever reported back to its client.
+class CompileServer {
+public:
+    CompileServer(std::string socketPath, CompileOptions options,
+                  unsigned threadCount = std::thread::hardware_concurrency())
+        : socketPath(std::move(socketPath)), options(std::move(options)), threadCount(std::max(1u, threadCount)) {}
+
+    // Serves until a client sends SHUTDOWN. False if the socket cannot be set up.
+    bool run(std::ostream& log) {
+        std::signal(SIGPIPE, SIG_IGN);  // A client that hangs up must not take the server down
+        sockaddr_un address{};
+        if (!makeSocketAddress(socketPath, address)) {
+            log << "Error: Socket path is empty or too long: " << socketPath << std::endl;
+            return false;
+        }
+        listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        ::unlink(socketPath.c_str());  // Left behind by a server that did not shut down cleanly
+        if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listener, SOMAXCONN) != 0 || ::fcntl(listener, F_SETFL, O_NONBLOCK) != 0 ||
+            ::pipe(wake) != 0) {
+            log << "Error: Could not listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+            if (listener >= 0) ::close(listener);
+            return false;
+        }
+        ::fcntl(wake[0], F_SETFL, O_NONBLOCK);
+        ::fcntl(wake[1], F_SETFL, O_NONBLOCK);  // A full pipe already means the poller will wake
+        log << "Listening on " << socketPath << " with " << threadCount << " worker(s)" << std::endl;
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < threadCount; i++) {
+            workers.emplace_back([this] { work(); });
+        }
+        poll();
+
+        // Requests not yet started are dropped. Idle connections are cut off
+        // now; the ones being served stop reading but still get their reply.
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            requests.clear();
+            ready.notify_all();
+        }
+        for (auto& [fd, connection] : connections) {
+            ::shutdown(fd, connection.busy ? SHUT_RD : SHUT_RDWR);
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        for (auto& [fd, connection] : connections) {
+            ::close(fd);
+        }
+        connections.clear();
+        ::close(wake[0]);
+        ::close(wake[1]);
+        ::close(listener);
+        ::unlink(socketPath.c_str());
+        log << "Served " << latencies.summary() << " (requests p50 p90 p99 max, in microseconds)" << std::endl;
+        return true;
+    }
+
+private:
+    // A reply that cannot be written in this long, because the client has
+    // stopped reading, drops the connection instead of holding a worker.
+    static constexpr int SEND_TIMEOUT_SECONDS = 10;
+
+    struct Connection {
+        std::string pending;  // Bytes read past the last complete line
+        bool busy = false;    // A worker has its request; not polled until it is done
+        bool ended = false;   // The client will send nothing more
+    };
+
+    struct Request {
+        int fd;
+        std::string line;  // Without its '\n'
+    };
+
+    std::string socketPath;
+    CompileOptions options;
+    unsigned threadCount;
+    int listener = -1;
+    int wake[2] = {-1, -1};  // Workers write a byte here when they hand a connection back
+    std::map<int, Connection> connections;  // Only the polling thread touches these
+    bool shuttingDown = false;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Request> requests;
+    std::vector<int> finished;  // Connections whose request is done, for the polling thread
+    bool stopping = false;
+    LatencyLog latencies;
+
+    // Returns once a client has sent SHUTDOWN or the listener fails.
+    void poll() {
+        std::vector<pollfd> polled;
+        while (!shuttingDown) {
+            polled.clear();
+            polled.push_back({wake[0], POLLIN, 0});
+            polled.push_back({listener, POLLIN, 0});
+            for (auto& [fd, connection] : connections) {
+                if (!connection.busy && !connection.ended) polled.push_back({fd, POLLIN, 0});
+            }
+            if (::poll(polled.data(), polled.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+
+            if (polled[0].revents != 0) {
+                char drained[64];
+                while (::read(wake[0], drained, sizeof(drained)) > 0) {
+                }
+                std::vector<int> done;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done.swap(finished);
+                }
+                for (int fd : done) {
+                    connections[fd].busy = false;
+                    dispatch(fd);
+                }
+            }
+            for (std::size_t i = 2; i < polled.size() && !shuttingDown; i++) {
+                if (polled[i].revents != 0) receive(polled[i].fd);
+            }
+            // Accept last, so a new connection cannot reuse the number of one closed above
+            if (polled[1].revents & (POLLERR | POLLNVAL)) return;
+            if (polled[1].revents != 0) accept();
+        }
+    }
+
+    void accept() {
+        while (!shuttingDown) {
+            int client = ::accept(listener, nullptr, nullptr);
+            if (client < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                return;  // EAGAIN: none left
+            }
+            timeval timeout{SEND_TIMEOUT_SECONDS, 0};
+            ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            connections[client] = Connection{};
+        }
+    }
+
+    // Reads what a polled connection has, then serves any lines it completed.
+    void receive(int fd) {
+        Connection& connection = connections[fd];
+        char chunk[4096];
+        ssize_t bytesRead = ::read(fd, chunk, sizeof(chunk));
+        if (bytesRead < 0 && errno == EINTR) return;
+        if (bytesRead <= 0) {
+            connection.ended = true;
+        } else {
+            connection.pending.append(chunk, static_cast<std::size_t>(bytesRead));
+        }
+        dispatch(fd);
+    }
+
+    // Takes the connection's lines in order until one goes to a worker, none
+    // is complete, or the connection is finished with and closed.
+    void dispatch(int fd) {
+        Connection& connection = connections[fd];
+        while (!connection.busy && !shuttingDown) {
+            std::size_t newline = connection.pending.find('\n');
+            if (newline == std::string::npos) {
+                if (connection.ended) break;
+                return;
+            }
+            std::string request(connection.pending, 0, newline);
+            connection.pending.erase(0, newline + 1);
+            if (!request.empty() && request.back() == '\r') request.pop_back();
+
+            if (request == "SHUTDOWN") {
+                // Never waits: a client that is not reading its replies
+                // goes without its BYE rather than keep the server up
+                ssize_t ignored = ::send(fd, "BYE\n", 4, MSG_DONTWAIT);
+                (void)ignored;
+                shuttingDown = true;
+                break;
+            }
+            connection.busy = true;
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back({fd, std::move(request)});
+            ready.notify_one();
+        }
+        if (!connection.busy && !shuttingDown) {
+            ::close(fd);
+            connections.erase(fd);
+        }
+    }
+
+    void work() {
+        CompileWorkspace workspace;
+        Interner interner;
+        workspace.interner = &interner;
+        while (true) {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return stopping || !requests.empty(); });
+                if (stopping) return;
+                request = std::move(requests.front());
+                requests.pop_front();
+            }
+            // Nothing from the last request is still in use, so its names and
+            // literals go, and memory stays bounded by the largest request
+            interner.clear();
+            if (!writeAll(request.fd, answer(request.line, workspace))) {
+                ::shutdown(request.fd, SHUT_RDWR);  // So the polling thread sees it end and closes it
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back(request.fd);
+            }
+            char byte = 0;
+            ssize_t ignored = ::write(wake[1], &byte, 1);
+            (void)ignored;
+        }
+    }
+
+    std::string answer(const std::string& request, CompileWorkspace& workspace) {
+        if (request.rfind("COMPILE ", 0) == 0) return compile(request.substr(8), workspace);
+        if (request == "STATS") return "STATS " + latencies.summary() + "\n";
+        return "ERROR Unknown request\n";
+    }
+
+    std::string compile(const std::string& path, CompileWorkspace& workspace) {
+        auto start = std::chrono::steady_clock::now();
+        CompileResult result = compileFile(path, options, workspace);
+        std::ostringstream reply;
+        if (!result.opened) {
+            reply << "ERROR " << result.error << '\n';
+        } else {
+            result.diagnostics.print(reply, path);
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            latencies.record(static_cast<std::uint64_t>(elapsed.count()));
+            reply << "OK " << result.diagnostics.size() << ' ' << elapsed.count() << '\n';
+        }
+        return reply.str();
+    }
+};
+
+// The thin client: sends one COMPILE per file over a single connection and
+// prints the replies the way a local run would. With no files it asks for
+// the server's latency statistics instead.
+inline int runCompileClient(const std::string& socketPath, const std::vector<std::string>& paths, bool shutdownServer) {
+    sockaddr_un address{};
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || !makeSocketAddress(socketPath, address) ||
+        ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Error: Could not connect to " << socketPath << std::endl;
+        if (fd >= 0) ::close(fd);
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    LineChannel channel(fd);
+
+    int status = 0;
+    std::string line;
+    for (const std::string& path : paths) {
+        std::error_code error;
+        std::filesystem::path absolute = std::filesystem::absolute(path, error);
+        bool answered = false;
+        if (!channel.write("COMPILE " + (error ? path : absolute.string()) + "\n")) break;
+        while (!answered && channel.readLine(line)) {
+            answered = line.rfind("OK ", 0) == 0 || line.rfind("ERROR ", 0) == 0;
+            if (line.rfind("OK ", 0) == 0) {
+                unsigned long errors = std::strtoul(line.c_str() + 3, nullptr, 10);
+                if (errors == 0) {
+                    std::cout << "Parsing completed successfully" << std::endl;
+                } else {
+                    std::cout << "Parsing failed with " << errors << " error(s)" << std::endl;
+                }
+            } else if (answered) {
+                std::cerr << "Error: " << line.substr(6) << std::endl;
+                status = 1;
+            } else {
+                std::cerr << line << '\n';
+            }
+        }
+        if (!answered) {
+            std::cerr << "Error: The server closed the connection" << std::endl;
+            return 1;
+        }
+    }
+    if (paths.empty() && !shutdownServer && channel.write("STATS\n") && channel.readLine(line)) {
+        std::cout << line << " (requests p50 p90 p99 max, in microseconds)" << std::endl;
+    }
+    if (shutdownServer && channel.write("SHUTDOWN\n")) {
+        channel.readLine(line);
+    }
+    return status;
+}
+
+#endif // _WIN32
+
+#endif // COMPILESERVER_HPP
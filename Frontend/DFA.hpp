@@ -1,113 +1,216 @@
 #ifndef DFA_HPP
 #define DFA_HPP
 
-#include <regex>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
 enum class State {
     START,
     IN_KEYWORD,
     IN_NUMBER,
+    IN_NUMBER_DOT,  // Digits and a '.', not a token until a fraction digit follows
+    IN_FRACTION,
     IN_OPERATOR,
     IN_DELIMITER,
-    DONE
+    IN_UNKNOWN,     // A byte no token can start with, scanned on its own
+    DONE            // The byte does not extend the token; it is left for the next one
 };
 
+// Character classes the DFA distinguishes. They mirror the token patterns:
+//   identifier  ^[a-zA-Z_][a-zA-Z0-9_]*$
+//   number      ^[0-9]+(\.[0-9]+)?$
+//   operator    one of OPERATORS below, built from [+\-*/=<>!&|^%]
+//   delimiter   [(){}[\];,]
+enum class CharClass : std::uint8_t {
+    OTHER,
+    LETTER,     // [a-zA-Z_]
+    DIGIT,      // [0-9]
+    OPERATOR,   // [+\-*/=<>!&|^%]
+    DELIMITER   // [(){}[\];,]
+};
+
+constexpr std::size_t STATE_COUNT = static_cast<std::size_t>(State::DONE) + 1;
+
+using CharClassTable = std::array<CharClass, 256>;
+using TransitionTable = std::array<std::array<State, 256>, STATE_COUNT>;
+
+constexpr std::string_view OPERATOR_CHARS = "+-*/=<>!&|^%";
+
+constexpr CharClassTable buildCharClassTable() {
+    CharClassTable table{};
+    for (auto& cls : table) {
+        cls = CharClass::OTHER;
+    }
+    for (int ch = 'a'; ch <= 'z'; ch++) table[ch] = CharClass::LETTER;
+    for (int ch = 'A'; ch <= 'Z'; ch++) table[ch] = CharClass::LETTER;
+    table['_'] = CharClass::LETTER;
+    for (int ch = '0'; ch <= '9'; ch++) table[ch] = CharClass::DIGIT;
+    for (char ch : OPERATOR_CHARS) {
+        table[static_cast<unsigned char>(ch)] = CharClass::OPERATOR;
+    }
+    for (char ch : {'(', ')', '{', '}', '[', ']', ';', ','}) {
+        table[static_cast<unsigned char>(ch)] = CharClass::DELIMITER;
+    }
+    return table;
+}
+
+constexpr CharClassTable CHAR_CLASSES = buildCharClassTable();
+
+// Every operator the scanner knows. A run of operator characters is split
+// into the longest operators from this set, so "=-" is "=" then "-".
+constexpr std::array<std::string_view, 33> OPERATORS = {
+    "+", "-", "*", "/", "=", "<", ">", "!", "&", "|", "^", "%",
+    "==", "!=", "<=", ">=", "&&", "||", "<<", ">>", "->", "++", "--",
+    "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=",
+    "<<=", ">>="
+};
+
+constexpr std::size_t MAX_OPERATOR_LENGTH = 3;
+
+// An operator prefix is encoded as a number in base OPERATOR_BASE, one digit
+// (1 + index in OPERATOR_CHARS) per character, so extending it by one byte is
+// a multiply and an add and membership in OPERATORS is a table lookup.
+constexpr std::size_t OPERATOR_BASE = OPERATOR_CHARS.size() + 1;
+constexpr std::size_t OPERATOR_CODE_LIMIT = OPERATOR_BASE * OPERATOR_BASE * OPERATOR_BASE;
+static_assert(MAX_OPERATOR_LENGTH == 3, "OPERATOR_CODE_LIMIT assumes three-character operators at most");
+
+using OperatorDigitTable = std::array<std::uint8_t, 256>;
+using OperatorCodeTable = std::array<bool, OPERATOR_CODE_LIMIT>;
+
+constexpr OperatorDigitTable buildOperatorDigitTable() {
+    OperatorDigitTable table{};
+    for (std::size_t i = 0; i < OPERATOR_CHARS.size(); i++) {
+        table[static_cast<unsigned char>(OPERATOR_CHARS[i])] = static_cast<std::uint8_t>(i + 1);
+    }
+    return table;
+}
+
+constexpr OperatorDigitTable OPERATOR_DIGITS = buildOperatorDigitTable();
+
+constexpr std::size_t operatorCode(std::string_view op) {
+    std::size_t code = 0;
+    for (char ch : op) {
+        code = code * OPERATOR_BASE + OPERATOR_DIGITS[static_cast<unsigned char>(ch)];
+    }
+    return code;
+}
+
+constexpr OperatorCodeTable buildOperatorCodeTable() {
+    OperatorCodeTable table{};
+    for (std::string_view op : OPERATORS) {
+        table[operatorCode(op)] = true;
+    }
+    return table;
+}
+
+constexpr OperatorCodeTable IS_OPERATOR = buildOperatorCodeTable();
+
+// The DFA stops at the first byte that does not extend the operator, which is
+// only the longest match if it never has to back up: every prefix of an
+// operator must be an operator too.
+constexpr bool operatorPrefixesAreOperators() {
+    for (std::string_view op : OPERATORS) {
+        if (op.size() > MAX_OPERATOR_LENGTH) return false;
+        for (std::size_t length = 1; length < op.size(); length++) {
+            if (!IS_OPERATOR[operatorCode(op.substr(0, length))]) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(operatorPrefixesAreOperators(), "an operator prefix is missing from OPERATORS");
+
+// Next state for every (state, byte) pair. Each state only looks at the class
+// of the incoming byte, except IN_OPERATOR, which DFA::transition refines with
+// the operator set. DONE means the byte is not part of the token.
+constexpr TransitionTable buildTransitionTable() {
+    TransitionTable table{};
+    for (std::size_t byte = 0; byte < 256; byte++) {
+        CharClass cls = CHAR_CLASSES[byte];
+
+        State fromStart = State::IN_UNKNOWN;
+        switch (cls) {
+            case CharClass::OPERATOR: fromStart = State::IN_OPERATOR; break;
+            case CharClass::DIGIT: fromStart = State::IN_NUMBER; break;
+            case CharClass::LETTER: fromStart = State::IN_KEYWORD; break;
+            case CharClass::DELIMITER: fromStart = State::IN_DELIMITER; break;
+            default: break;
+        }
+
+        table[static_cast<std::size_t>(State::START)][byte] = fromStart;
+        table[static_cast<std::size_t>(State::IN_KEYWORD)][byte] =
+            cls == CharClass::LETTER || cls == CharClass::DIGIT ? State::IN_KEYWORD : State::DONE;
+        table[static_cast<std::size_t>(State::IN_NUMBER)][byte] =
+            cls == CharClass::DIGIT ? State::IN_NUMBER : byte == '.' ? State::IN_NUMBER_DOT : State::DONE;
+        table[static_cast<std::size_t>(State::IN_NUMBER_DOT)][byte] =
+            cls == CharClass::DIGIT ? State::IN_FRACTION : State::DONE;
+        table[static_cast<std::size_t>(State::IN_FRACTION)][byte] =
+            cls == CharClass::DIGIT ? State::IN_FRACTION : State::DONE;
+        table[static_cast<std::size_t>(State::IN_OPERATOR)][byte] =
+            cls == CharClass::OPERATOR ? State::IN_OPERATOR : State::DONE;
+        table[static_cast<std::size_t>(State::IN_DELIMITER)][byte] = State::DONE;
+        table[static_cast<std::size_t>(State::IN_UNKNOWN)][byte] = State::DONE;
+        table[static_cast<std::size_t>(State::DONE)][byte] = State::DONE;
+    }
+    return table;
+}
+
+constexpr TransitionTable TRANSITIONS = buildTransitionTable();
+
+static_assert(TRANSITIONS[static_cast<std::size_t>(State::START)]['x'] == State::IN_KEYWORD, "letters start identifiers");
+static_assert(TRANSITIONS[static_cast<std::size_t>(State::START)]['7'] == State::IN_NUMBER, "digits start numbers");
+static_assert(TRANSITIONS[static_cast<std::size_t>(State::IN_KEYWORD)]['7'] == State::IN_KEYWORD, "digits continue identifiers");
+static_assert(TRANSITIONS[static_cast<std::size_t>(State::IN_NUMBER_DOT)]['x'] == State::DONE, "a lone '.' ends a number");
+
 class DFA {
 public:
-    DFA() : currentState(State::START) {
-        initializeRegexPatterns();
-    }
+    DFA() : currentState(State::START), currentOperator(0) {}
 
     [[nodiscard]] State getCurrentState() const {
         return currentState;
     }
 
-    void transition(char ch) {
-        switch (currentState) {
-            case State::START:
-                if (isRegexMatch(std::string(1, ch), operatorRegex)) {
-                    currentState = State::IN_OPERATOR;
-                } else if (isRegexMatch(std::string(1, ch), numberRegex)) {
-                    currentState = State::IN_NUMBER;
-                } else if (isRegexMatch(std::string(1, ch), identifierRegex)) {
-                    currentState = State::IN_KEYWORD;
-                } else if (isRegexMatch(std::string(1, ch), delimiterRegex)) {
-                    currentState = State::IN_DELIMITER;
-                } else {
-                    currentState = State::START;
-                }
-                break;
-
-            case State::IN_KEYWORD:
-                if (isRegexMatch(std::string(1, ch), identifierRegex)) {
-                    currentState = State::IN_KEYWORD;
-                } else {
-                    currentState = State::DONE;
-                }
-                break;
-
-            case State::IN_NUMBER:
-                if (isRegexMatch(std::string(1, ch), numberRegex)) {
-                    currentState = State::IN_NUMBER;
-                } else {
-                    currentState = State::DONE;
-                }
-                break;
-
-            case State::IN_OPERATOR:
-                tempOperator += ch;
-                if (isRegexMatch(tempOperator, operatorRegex)) {
-                    currentState = State::IN_OPERATOR;
-                } else {
-                    currentState = State::DONE;
-                }
-                break;
-
-            case State::IN_DELIMITER:
-                currentState = State::DONE;
-                break;
-
-            default:
-                currentState = State::START;
-                break;
+    // Feeds one byte and returns the new state. O(1) in every state.
+    State transition(char ch) {
+        auto byte = static_cast<unsigned char>(ch);
+        State next = TRANSITIONS[static_cast<std::size_t>(currentState)][byte];
+        if (next == State::IN_OPERATOR) {
+            std::size_t extended = currentState == State::IN_OPERATOR
+                ? currentOperator * OPERATOR_BASE + OPERATOR_DIGITS[byte]
+                : OPERATOR_DIGITS[byte];
+            if (extended < OPERATOR_CODE_LIMIT && IS_OPERATOR[extended]) {
+                currentOperator = extended;
+            } else {
+                next = State::DONE;
+            }
         }
+        currentState = next;
+        return next;
     }
 
     void reset() {
         currentState = State::START;
-        tempOperator.clear();
+        currentOperator = 0;
     }
 
-    const std::string& getTempOperator() const {
-        return tempOperator;
+    // Whether the bytes fed so far form a complete token
+    static constexpr bool isAccepting(State state) {
+        return state != State::START && state != State::IN_NUMBER_DOT && state != State::DONE;
     }
 
-    bool isDelimiterChar(char ch) {
-        return isRegexMatch(std::string(1, ch), delimiterRegex);
+    static bool isDelimiterChar(char ch) {
+        return classify(ch) == CharClass::DELIMITER;
     }
 
-private:
-    State currentState;
-    std::string tempOperator;  // Store the operator string being built
-
-    // Regular expressions for different token types
-    std::regex identifierRegex;
-    std::regex numberRegex;
-    std::regex operatorRegex;
-    std::regex delimiterRegex;
-
-    // Initialize regex patterns
-    void initializeRegexPatterns() {
-        identifierRegex = std::regex("^[a-zA-Z_][a-zA-Z0-9_]*$");  // Identifiers
-        numberRegex = std::regex("^[0-9]+(\\.[0-9]+)?$");  // Numbers
-        operatorRegex = std::regex("^[+\\-*/=<>!&|^%]+$");  // Operators (math/logical)
-        delimiterRegex = std::regex(R"([(){}[\];,])");  // Delimiters (can extend as needed)
+    static CharClass classify(char ch) {
+        return CHAR_CLASSES[static_cast<unsigned char>(ch)];
     }
 
-    // Check if a string matches a regex pattern
-    static bool isRegexMatch(const std::string& value, const std::regex& pattern) {
-        return std::regex_match(value, pattern);
-    }
+private:
+    State currentState;
+    std::size_t currentOperator;  // operatorCode of the operator read so far
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,56 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Token.hpp"
+
+struct Diagnostic {
+    int line;
+    int column;
+    std::string message;
+};
+
+// Errors collected during a pass instead of printed as they happen, so one
+// run reports all of them and the caller decides where they go.
+class Diagnostics {
+public:
+    void report(const Token& at, std::string message) {
+        entries.push_back({at.line, at.column, std::move(message)});
+    }
+
+    [[nodiscard]] const std::vector<Diagnostic>& all() const {
+        return entries;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return entries.empty();
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return entries.size();
+    }
+
+    void clear() {
+        entries.clear();
+    }
+
+    // One "Syntax Error: ... at line L, column C" line per diagnostic, each
+    // led by "<file>: " when a file is given
+    void print(std::ostream& out, std::string_view file = {}) const {
+        for (const Diagnostic& diagnostic : entries) {
+            if (!file.empty()) out << file << ": ";
+            out << "Syntax Error: " << diagnostic.message << " at line " << diagnostic.line
+                << ", column " << diagnostic.column << '\n';
+        }
+    }
+
+private:
+    std::vector<Diagnostic> entries;
+};
+
+#endif // DIAGNOSTICS_HPP
@@ -0,0 +1,166 @@
+#ifndef EXPRESSIONPARSER_HPP
+#define EXPRESSIONPARSER_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DFA.hpp"
+#include "Diagnostics.hpp"
+#include "Token.hpp"
+#include "TokenStream.hpp"
+
+// Binding power of every binary operator, indexed by operatorCode; higher
+// binds tighter and 0 means the operator cannot join two operands. The levels
+// follow C. All binary operators are left-associative.
+using PrecedenceTable = std::array<std::uint8_t, OPERATOR_CODE_LIMIT>;
+
+constexpr std::uint8_t PREFIX_POWER = 11;  // Above every binary operator
+
+constexpr PrecedenceTable buildBinaryPrecedence() {
+    PrecedenceTable table{};
+    struct Level {
+        std::uint8_t power;
+        std::string_view operators[4];
+    };
+    constexpr Level levels[] = {
+        {1, {"||"}},
+        {2, {"&&"}},
+        {3, {"|"}},
+        {4, {"^"}},
+        {5, {"&"}},
+        {6, {"==", "!="}},
+        {7, {"<", ">", "<=", ">="}},
+        {8, {"<<", ">>"}},
+        {9, {"+", "-"}},
+        {10, {"*", "/", "%"}},
+    };
+    for (const Level& level : levels) {
+        for (std::string_view op : level.operators) {
+            if (!op.empty()) table[operatorCode(op)] = level.power;
+        }
+    }
+    return table;
+}
+
+constexpr PrecedenceTable BINARY_PRECEDENCE = buildBinaryPrecedence();
+
+constexpr bool isPrefixOperator(std::size_t code) {
+    return code == operatorCode("-") || code == operatorCode("+") || code == operatorCode("!");
+}
+
+static_assert(BINARY_PRECEDENCE[operatorCode("*")] > BINARY_PRECEDENCE[operatorCode("+")], "* binds tighter than +");
+static_assert(BINARY_PRECEDENCE[operatorCode("=")] == 0, "assignment is not an expression operator");
+
+// One node of a parsed expression in post-order: operands come before the
+// operator that combines them, so the sequence can be evaluated with a stack.
+struct ExpressionItem {
+    Token token;
+    std::uint32_t position;  // Of the token in the token stream
+    std::uint8_t arity;      // 0 for an operand, 1 for a prefix operator, 2 for a binary one
+};
+
+// Parses an expression by operator precedence (Pratt / shunting-yard) with an
+// explicit operator stack instead of recursion, so deep nesting and long
+// operator chains cost linear time and no native stack.
+//
+//   <Expr>    ::= <Prefix> { <BinaryOp> <Prefix> }
+//   <Prefix>  ::= { "-" | "+" | "!" } <Primary>
+//   <Primary> ::= "IDENTIFIER" | "NUMBER" | "(" <Expr> ")"
+class ExpressionParser {
+public:
+    ExpressionParser(TokenStream& tokens, std::string_view source, Diagnostics& diagnostics)
+        : tokens(tokens), source(source), diagnostics(diagnostics) {}
+
+    // Parses one expression from the current token and leaves the stream on
+    // the first token after it. The expression is written to `postfix`; on a
+    // syntax error it is reported to the diagnostics and false is returned.
+    bool parse(std::vector<ExpressionItem>& postfix) {
+        postfix.clear();
+        operators.clear();
+        std::size_t openParens = 0;
+        bool expectOperand = true;
+
+        while(true) {
+            const Token& token = tokens.peek();
+            auto position = static_cast<std::uint32_t>(tokens.position());
+            if(expectOperand) {
+                if(token.type == TokenType::IDENTIFIER || token.type == TokenType::NUMBER) {
+                    postfix.push_back({tokens.next(), position, 0});
+                    expectOperand = false;
+                }else if(isDelimiter(token, '(')) {
+                    operators.push_back({tokens.next(), position, 0, 0});
+                    openParens++;
+                }else if(token.type == TokenType::OPERATOR && isPrefixOperator(codeOf(token))) {
+                    operators.push_back({tokens.next(), position, PREFIX_POWER, 1});
+                }else {
+                    return error("Identifier, Number or (");
+                }
+                continue;
+            }
+
+            if(token.type == TokenType::OPERATOR && BINARY_PRECEDENCE[codeOf(token)] != 0) {
+                std::uint8_t power = BINARY_PRECEDENCE[codeOf(token)];
+                // Left-associative: anything pending that binds at least as tightly goes first
+                while(!operators.empty() && operators.back().arity != 0 && operators.back().power >= power) {
+                    reduce(postfix);
+                }
+                operators.push_back({tokens.next(), position, power, 2});
+                expectOperand = true;
+            }else if(openParens > 0 && isDelimiter(token, ')')) {
+                while(operators.back().arity != 0) {
+                    reduce(postfix);
+                }
+                operators.pop_back();
+                openParens--;
+                tokens.next();
+            }else {
+                break;
+            }
+        }
+
+        if(openParens > 0) {
+            return error(")");
+        }
+        while(!operators.empty()) {
+            reduce(postfix);
+        }
+        return true;
+    }
+
+private:
+    struct PendingOperator {
+        Token token;
+        std::uint32_t position;
+        std::uint8_t power;
+        std::uint8_t arity;  // 0 marks an open parenthesis
+    };
+
+    TokenStream& tokens;
+    std::string_view source;
+    Diagnostics& diagnostics;
+    std::vector<PendingOperator> operators;  // Reused across expressions
+
+    void reduce(std::vector<ExpressionItem>& postfix) {
+        postfix.push_back({operators.back().token, operators.back().position, operators.back().arity});
+        operators.pop_back();
+    }
+
+    [[nodiscard]] std::size_t codeOf(const Token& token) const {
+        return operatorCode(token.text(source));
+    }
+
+    [[nodiscard]] bool isDelimiter(const Token& token, char ch) const {
+        return token.type == TokenType::DELIMITER && token.text(source)[0] == ch;
+    }
+
+    bool error(const std::string& expected) {
+        const Token& token = tokens.peek();
+        std::string got = token.type == TokenType::END ? "end of input" : std::string(token.text(source));
+        diagnostics.report(token, "Expected " + expected + " but got " + got);
+        return false;
+    }
+};
+
+#endif // EXPRESSIONPARSER_HPP
@@ -0,0 +1,161 @@
+#ifndef GRAMMAR_HPP
+#define GRAMMAR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+enum class NonTerminal {S, VarDec, OptAssign, Expr};
+enum class Terminal {TYPE, IDENTIFIER, NUMBER, ASSIGN, SEMICOLON, UNKNOWN, END};
+
+constexpr std::size_t NONTERMINAL_COUNT = static_cast<std::size_t>(NonTerminal::Expr) + 1;
+constexpr std::size_t TERMINAL_COUNT = static_cast<std::size_t>(Terminal::END) + 1;
+
+// A grammar symbol on the right-hand side of a production or on the parse stack.
+struct Symbol {
+    bool isTerminal;
+    std::uint8_t id;
+
+    constexpr Symbol() : isTerminal(true), id(0) {}
+    constexpr Symbol(Terminal terminal) : isTerminal(true), id(static_cast<std::uint8_t>(terminal)) {}
+    constexpr Symbol(NonTerminal nonTerminal) : isTerminal(false), id(static_cast<std::uint8_t>(nonTerminal)) {}
+
+    [[nodiscard]] constexpr Terminal terminal() const { return static_cast<Terminal>(id); }
+    [[nodiscard]] constexpr NonTerminal nonTerminal() const { return static_cast<NonTerminal>(id); }
+};
+
+constexpr std::size_t MAX_RHS = 4;
+
+struct Production {
+    NonTerminal lhs;
+    std::uint8_t length;
+    Symbol rhs[MAX_RHS];
+};
+
+// The BNF from the README, one alternative per production. <Expr> has no
+// productions here: Parser hands it to ExpressionParser, which parses by
+// operator precedence instead of from the table.
+constexpr Production GRAMMAR[] = {
+    // <S> ::= <VarDec> <S> | epsilon
+    {NonTerminal::S, 2, {NonTerminal::VarDec, NonTerminal::S}},
+    {NonTerminal::S, 0, {}},
+    // <VarDec> ::= <Type> "IDENTIFIER" <OptAssign> ";"
+    {NonTerminal::VarDec, 4, {Terminal::TYPE, Terminal::IDENTIFIER, NonTerminal::OptAssign, Terminal::SEMICOLON}},
+    // <OptAssign> ::= "=" <Expr> | epsilon
+    {NonTerminal::OptAssign, 2, {Terminal::ASSIGN, NonTerminal::Expr}},
+    {NonTerminal::OptAssign, 0, {}},
+};
+
+constexpr std::size_t PRODUCTION_COUNT = sizeof(GRAMMAR) / sizeof(GRAMMAR[0]);
+
+using TerminalSet = std::uint32_t;  // Bit i stands for Terminal i
+static_assert(TERMINAL_COUNT <= 32, "TerminalSet is too narrow");
+
+constexpr TerminalSet terminalBit(Terminal terminal) {
+    return TerminalSet(1) << static_cast<unsigned>(terminal);
+}
+
+constexpr std::int8_t NO_PRODUCTION = -1;
+
+// Everything the predictive parser needs, derived from GRAMMAR at compile time.
+struct GrammarTables {
+    bool nullable[NONTERMINAL_COUNT];
+    TerminalSet first[NONTERMINAL_COUNT];
+    TerminalSet follow[NONTERMINAL_COUNT];
+    std::int8_t parseTable[NONTERMINAL_COUNT][TERMINAL_COUNT];  // Production index or NO_PRODUCTION
+    bool conflict;  // Two productions claimed the same table cell: not LL(1)
+};
+
+// FIRST of rhs[from..], and whether that whole suffix can derive epsilon.
+constexpr TerminalSet firstOfSequence(const GrammarTables& tables, const Production& production,
+                                      std::size_t from, bool& nullable) {
+    TerminalSet result = 0;
+    for (std::size_t i = from; i < production.length; i++) {
+        Symbol symbol = production.rhs[i];
+        if (symbol.isTerminal) {
+            result |= terminalBit(symbol.terminal());
+            nullable = false;
+            return result;
+        }
+        result |= tables.first[symbol.id];
+        if (!tables.nullable[symbol.id]) {
+            nullable = false;
+            return result;
+        }
+    }
+    nullable = true;
+    return result;
+}
+
+constexpr GrammarTables buildGrammarTables() {
+    GrammarTables tables{};
+
+    // NULLABLE and FIRST, iterated to a fixed point
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const Production& production : GRAMMAR) {
+            auto lhs = static_cast<std::size_t>(production.lhs);
+            bool nullable = false;
+            TerminalSet first = firstOfSequence(tables, production, 0, nullable);
+            if ((tables.first[lhs] | first) != tables.first[lhs]) {
+                tables.first[lhs] |= first;
+                changed = true;
+            }
+            if (nullable && !tables.nullable[lhs]) {
+                tables.nullable[lhs] = true;
+                changed = true;
+            }
+        }
+    }
+
+    // FOLLOW, with END following the start symbol
+    tables.follow[static_cast<std::size_t>(NonTerminal::S)] = terminalBit(Terminal::END);
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const Production& production : GRAMMAR) {
+            for (std::size_t i = 0; i < production.length; i++) {
+                Symbol symbol = production.rhs[i];
+                if (symbol.isTerminal) continue;
+                bool restNullable = false;
+                TerminalSet follow = firstOfSequence(tables, production, i + 1, restNullable);
+                if (restNullable) {
+                    follow |= tables.follow[static_cast<std::size_t>(production.lhs)];
+                }
+                if ((tables.follow[symbol.id] | follow) != tables.follow[symbol.id]) {
+                    tables.follow[symbol.id] |= follow;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Parse table: predict a production on FIRST of its body, or on FOLLOW of
+    // its head when the body can vanish
+    for (auto& row : tables.parseTable) {
+        for (auto& cell : row) {
+            cell = NO_PRODUCTION;
+        }
+    }
+    for (std::size_t p = 0; p < PRODUCTION_COUNT; p++) {
+        const Production& production = GRAMMAR[p];
+        auto lhs = static_cast<std::size_t>(production.lhs);
+        bool nullable = false;
+        TerminalSet predict = firstOfSequence(tables, production, 0, nullable);
+        if (nullable) {
+            predict |= tables.follow[lhs];
+        }
+        for (std::size_t t = 0; t < TERMINAL_COUNT; t++) {
+            if (!(predict & terminalBit(static_cast<Terminal>(t)))) continue;
+            if (tables.parseTable[lhs][t] != NO_PRODUCTION) {
+                tables.conflict = true;
+            }
+            tables.parseTable[lhs][t] = static_cast<std::int8_t>(p);
+        }
+    }
+    return tables;
+}
+
+constexpr GrammarTables GRAMMAR_TABLES = buildGrammarTables();
+
+static_assert(!GRAMMAR_TABLES.conflict, "GRAMMAR is not LL(1)");
+
+#endif // GRAMMAR_HPP
@@ -0,0 +1,319 @@
+#ifndef INCREMENTALSCANNER_HPP
+#define INCREMENTALSCANNER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Scanner.hpp"
+#include "Token.hpp"
+#include "TokenStream.hpp"
+
+// One edit to a document, in whole lines: the lines [firstLine, firstLine +
+// oldLineCount) of the document before the edit were replaced by
+// newLineCount lines. Lines count from 1; an oldLineCount of 0 inserts
+// before firstLine.
+struct LineEdit {
+    int firstLine;
+    int oldLineCount;
+    int newLineCount;
+};
+
+// Keeps the tokens of a document up to date as it is edited, re-scanning
+// only the lines around each edit. No token spans a newline, so any run of
+// whole lines scans the same on its own as inside the document.
+//
+// Tokens are kept in blocks of about BLOCK_LINES lines, each token's line
+// and offset relative to its block. An edit scans its new lines and splices
+// their tokens into the blocks it touches, which are split anew; the blocks
+// after it move as a whole, so their tokens are not rewritten however far the
+// edit shifts them. Scanning costs the size of the edit, and the splice a
+// copy of the touched blocks plus one step per block in the document.
+//
+// This is for a front end that holds a document open across edits, such as
+// an editor integration. Nothing in this tree does yet: the command line and
+// the batch compiler see each file once, and the compile server clears its
+// interner between requests, which would leave held tokens with stale
+// symbols. IncrementalScannerTest checks it against whole rescans.
+class IncrementalScanner {
+public:
+    static constexpr std::size_t BLOCK_LINES = 256;
+
+    // Scans `source` from scratch.
+    void scan(std::string_view source) {
+        blocks.clear();
+        tokenTotal = 0;
+        Scanner scanner(source);
+        appendBlocks(blocks, source, true, scanner);
+        lastRescanned = source.size();
+    }
+
+    // Brings the tokens up to date with `source`, the whole document after
+    // `edits`. The edits must not overlap and their line numbers refer to the
+    // document before any of them. Only the new lines are scanned; the other
+    // tokens of the blocks they fall in are moved into place. Should the edits
+    // not fit the tokens held, the document is scanned from scratch.
+    void update(std::string_view source, std::vector<LineEdit> edits) {
+        if (blocks.empty()) {
+            scan(source);
+            return;
+        }
+        std::sort(edits.begin(), edits.end(),
+                  [](const LineEdit& a, const LineEdit& b) { return a.firstLine < b.firstLine; });
+
+        // Where each block starts in the document before the edits
+        std::vector<std::size_t> blockLine(blocks.size() + 1, 1);
+        std::vector<std::size_t> blockByte(blocks.size() + 1, 0);
+        for (std::size_t b = 0; b < blocks.size(); b++) {
+            blockLine[b + 1] = blockLine[b] + blocks[b].lineStarts.size();
+            blockByte[b + 1] = blockByte[b] + blocks[b].bytes;
+        }
+        std::size_t lineTotal = blockLine.back() - 1;
+        auto blockOf = [&](std::size_t line) {
+            return static_cast<std::size_t>(std::upper_bound(blockLine.begin(), blockLine.end() - 1, line) -
+                                            blockLine.begin()) - 1;
+        };
+        // Blocks are replaced in place, so old block b is now at b + moved
+        // for every b past the edits so far
+        std::ptrdiff_t moved = 0;
+        auto oldBlock = [&](std::size_t b) -> const Block& { return blocks[b + moved]; };
+        auto lineByte = [&](std::size_t line) {  // Start of `line`, or the end past the last line
+            if (line > lineTotal) return blockByte.back();
+            std::size_t b = blockOf(line);
+            return blockByte[b] + oldBlock(b).lineStarts[line - blockLine[b]];
+        };
+
+        std::vector<Token> spliced;
+        std::vector<Block> fresh;
+        std::size_t editedUpTo = 1;  // First old line after the edits so far
+        std::ptrdiff_t shift = 0;    // How far the edits so far moved the text after them
+        lastRescanned = 0;
+        for (std::size_t e = 0; e < edits.size();) {
+            // Edits in the same or neighbouring blocks are spliced together
+            std::size_t groupStart = e;
+            std::size_t first = 0, last = 0;
+            for (; e < edits.size(); e++) {
+                const LineEdit& edit = edits[e];
+                if (edit.firstLine < 1 || edit.oldLineCount < 0 || edit.newLineCount < 0 ||
+                    static_cast<std::size_t>(edit.firstLine) < editedUpTo ||
+                    static_cast<std::size_t>(edit.firstLine) + edit.oldLineCount > lineTotal + 1) {
+                    scan(source);  // Overlapping or out of range
+                    return;
+                }
+                std::size_t begin = static_cast<std::size_t>(edit.firstLine);
+                std::size_t end = begin + static_cast<std::size_t>(edit.oldLineCount);
+                std::size_t editFirst = blockOf(std::min(begin, lineTotal));
+                std::size_t editLast = end > begin ? blockOf(std::min(end - 1, lineTotal)) : editFirst;
+                if (e == groupStart) {
+                    first = editFirst;
+                } else if (editFirst > last + 1) {
+                    break;
+                }
+                last = std::max(last, editLast);
+                editedUpTo = end;
+            }
+
+            // The group's blocks become one region, its tokens numbered from
+            // the region's first line and byte
+            auto regionBegin = static_cast<std::ptrdiff_t>(blockByte[first]) + shift;
+            std::ptrdiff_t lineShift = 0;
+            spliced.clear();
+            std::size_t block = first, index = 0;
+            auto keepTokensBefore = [&](std::size_t line) {  // Old tokens on lines before `line`
+                for (; block <= last; block++, index = 0) {
+                    const Block& from = oldBlock(block);
+                    for (; index < from.tokens.size(); index++) {
+                        Token token = from.tokens[index];
+                        std::size_t tokenLine = blockLine[block] + static_cast<std::size_t>(token.line);
+                        if (tokenLine >= line) return;
+                        token.line = static_cast<int>(static_cast<std::ptrdiff_t>(tokenLine - blockLine[first]) +
+                                                      lineShift + 1);
+                        token.offset = static_cast<std::uint32_t>(
+                            static_cast<std::ptrdiff_t>(blockByte[block] + token.offset) + shift - regionBegin);
+                        spliced.push_back(token);
+                    }
+                }
+            };
+            for (std::size_t g = groupStart; g < e; g++) {
+                const LineEdit& edit = edits[g];
+                std::size_t begin = static_cast<std::size_t>(edit.firstLine);
+                std::size_t end = begin + static_cast<std::size_t>(edit.oldLineCount);
+                keepTokensBefore(begin);
+                std::size_t lineBefore = spliced.size();
+                keepTokensBefore(end);
+                spliced.resize(lineBefore);  // The replaced lines' tokens
+
+                std::size_t oldBegin = lineByte(begin), oldEnd = lineByte(end);
+                auto newBegin = static_cast<std::ptrdiff_t>(oldBegin) + shift;
+                if (static_cast<std::size_t>(newBegin) > source.size()) {
+                    scan(source);
+                    return;
+                }
+                std::size_t newEnd = skipLines(source, static_cast<std::size_t>(newBegin),
+                                               static_cast<std::size_t>(edit.newLineCount));
+                std::string_view text = source.substr(newBegin, newEnd - newBegin);
+                Scanner scanner(text, static_cast<int>(static_cast<std::ptrdiff_t>(begin - blockLine[first]) +
+                                                       lineShift + 1));
+                for (Token token; scanner.nextToken(token);) {
+                    token.offset += static_cast<std::uint32_t>(newBegin - regionBegin);
+                    spliced.push_back(token);
+                }
+                lastRescanned += text.size();
+                lineShift += edit.newLineCount - edit.oldLineCount;
+                shift += static_cast<std::ptrdiff_t>(newEnd) - newBegin - static_cast<std::ptrdiff_t>(oldEnd - oldBegin);
+            }
+            keepTokensBefore(lineTotal + 1);
+
+            bool atEnd = last + 1 == blocks.size();
+            auto regionEnd = static_cast<std::ptrdiff_t>(blockByte[last + 1]) + shift;
+            if (regionEnd < regionBegin || static_cast<std::size_t>(regionEnd) > source.size() ||
+                (atEnd && static_cast<std::size_t>(regionEnd) != source.size()) ||
+                (!atEnd && (regionEnd == 0 || source[regionEnd - 1] != '\n'))) {
+                scan(source);  // The edits do not describe how `source` differs from what was scanned
+                return;
+            }
+            for (std::size_t b = first; b <= last; b++) {
+                tokenTotal -= oldBlock(b).tokens.size();
+            }
+            fresh.clear();
+            VectorTokenSource tokens(spliced);
+            appendBlocks(fresh, source.substr(regionBegin, regionEnd - regionBegin), atEnd, tokens);
+
+            // Overwrite the group's blocks, then open or close the gap for the difference
+            auto at = blocks.begin() + (static_cast<std::ptrdiff_t>(first) + moved);
+            auto replaced = static_cast<std::ptrdiff_t>(last - first + 1);
+            auto common = std::min(replaced, static_cast<std::ptrdiff_t>(fresh.size()));
+            at = std::move(fresh.begin(), fresh.begin() + common, at);
+            if (replaced > common) {
+                blocks.erase(at, at + (replaced - common));
+            } else {
+                blocks.insert(at, std::make_move_iterator(fresh.begin() + common), std::make_move_iterator(fresh.end()));
+            }
+            moved += static_cast<std::ptrdiff_t>(fresh.size()) - replaced;
+        }
+        if (static_cast<std::ptrdiff_t>(blockByte.back()) + shift != static_cast<std::ptrdiff_t>(source.size())) {
+            scan(source);
+        }
+    }
+
+    [[nodiscard]] std::size_t tokenCount() const {
+        return tokenTotal;
+    }
+
+    // Bytes the last scan or update had to scan
+    [[nodiscard]] std::size_t rescannedBytes() const {
+        return lastRescanned;
+    }
+
+    // Hands out the tokens in order, with lines and offsets in the whole
+    // document, so they can feed a TokenStream like a Scanner would.
+    class Cursor : public TokenSource {
+    public:
+        explicit Cursor(const IncrementalScanner& scanner) : scanner(scanner) {}
+
+        bool nextToken(Token& token) override {
+            const std::vector<Block>& blocks = scanner.blocks;
+            while (block < blocks.size() && index == blocks[block].tokens.size()) {
+                blockLine += blocks[block].lineStarts.size();
+                blockByte += blocks[block].bytes;
+                block++;
+                index = 0;
+            }
+            if (block == blocks.size()) return false;
+            token = blocks[block].tokens[index++];
+            token.offset += static_cast<std::uint32_t>(blockByte);
+            token.line += static_cast<int>(blockLine);
+            return true;
+        }
+
+    private:
+        const IncrementalScanner& scanner;
+        std::size_t block = 0;
+        std::size_t index = 0;
+        std::size_t blockLine = 1;
+        std::size_t blockByte = 0;
+    };
+
+    [[nodiscard]] std::vector<Token> tokens() const {
+        std::vector<Token> result;
+        result.reserve(tokenTotal);
+        Cursor cursor(*this);
+        for (Token token; cursor.nextToken(token);) {
+            result.push_back(token);
+        }
+        return result;
+    }
+
+private:
+    // A run of whole lines. Token lines count from 0 at the block's first
+    // line and offsets from its first byte; columns need no adjusting, since
+    // a block starts at the start of a line.
+    struct Block {
+        std::size_t bytes = 0;
+        std::vector<std::uint32_t> lineStarts;
+        std::vector<Token> tokens;
+    };
+
+    std::vector<Block> blocks;
+    std::size_t tokenTotal = 0;
+    std::size_t lastRescanned = 0;
+
+    // Past `count` more newlines from `from`, or the end of the source.
+    static std::size_t skipLines(std::string_view source, std::size_t from, std::size_t count) {
+        for (; count > 0 && from < source.size(); count--) {
+            const void* newline = std::memchr(source.data() + from, '\n', source.size() - from);
+            from = newline ? static_cast<const char*>(newline) - source.data() + 1 : source.size();
+        }
+        return from;
+    }
+
+    // Splits `region`, whole lines, into blocks of BLOCK_LINES to twice as
+    // many lines, so that an edit adding a line or two splits no block, and
+    // files its tokens, numbered as a Scanner of the region would, into them.
+    // The empty line after a final newline belongs to the region only at the
+    // end of the document; elsewhere it is the first line of what follows.
+    void appendBlocks(std::vector<Block>& out, std::string_view region, bool atEnd, TokenSource& tokens) {
+        if (region.empty() && !atEnd) return;  // Every line in it was deleted
+        std::vector<std::uint32_t> lineStarts{0};
+        for (std::size_t at = 0; at < region.size();) {
+            const void* newline = std::memchr(region.data() + at, '\n', region.size() - at);
+            if (!newline) break;
+            at = static_cast<const char*>(newline) - region.data() + 1;
+            if (at < region.size() || atEnd) lineStarts.push_back(static_cast<std::uint32_t>(at));
+        }
+
+        std::size_t lineCount = lineStarts.size();
+        std::size_t blockCount = std::max<std::size_t>(1, lineCount / BLOCK_LINES);
+        std::size_t firstBlock = out.size();
+        for (std::size_t b = 0; b < blockCount; b++) {
+            Block block;
+            std::size_t line = lineCount * b / blockCount, endLine = lineCount * (b + 1) / blockCount;
+            std::size_t endByte = endLine < lineCount ? lineStarts[endLine] : region.size();
+            block.bytes = endByte - lineStarts[line];
+            for (std::size_t l = line; l < endLine; l++) {
+                block.lineStarts.push_back(lineStarts[l] - lineStarts[line]);
+            }
+            out.push_back(std::move(block));
+        }
+
+        std::size_t b = 0, blockLine = 0, blockEnd = lineCount / blockCount;
+        for (Token token; tokens.nextToken(token);) {
+            auto line = static_cast<std::size_t>(token.line) - 1;
+            while (line >= blockEnd) {  // Tokens come in order, so blocks are only ever left behind
+                b++;
+                blockLine = blockEnd;
+                blockEnd = lineCount * (b + 1) / blockCount;
+            }
+            token.offset -= lineStarts[blockLine];
+            token.line = static_cast<int>(line - blockLine);
+            out[firstBlock + b].tokens.push_back(token);
+            tokenTotal++;
+        }
+    }
+};
+
+#endif // INCREMENTALSCANNER_HPP
@@ -0,0 +1,235 @@
+#ifndef INTERNER_HPP
+#define INTERNER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+using SymbolId = std::uint32_t;
+
+constexpr SymbolId NO_SYMBOL = UINT32_MAX;
+
+// Hashes eight bytes at a time and finishes with MurmurHash3's fmix64, so
+// both the low bits (shard) and the high bits (cache line) are well mixed.
+// Most lexemes fit in a single word.
+inline std::uint64_t hashLexeme(std::string_view text) {
+    std::uint64_t hash = text.size() * 0x9E3779B97F4A7C15ull;
+    const char* cursor = text.data();
+    std::size_t left = text.size();
+    for (; left >= 8; cursor += 8, left -= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, cursor, 8);
+        hash = (hash ^ word) * 0x87C37B91114253D5ull;
+        hash ^= hash >> 31;
+    }
+    if (left > 0) {
+        std::uint64_t word = 0;
+        for (std::size_t i = 0; i < left; i++) {
+            word |= std::uint64_t(static_cast<unsigned char>(cursor[i])) << (8 * i);
+        }
+        hash = (hash ^ word) * 0x87C37B91114253D5ull;
+        hash ^= hash >> 31;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Maps every distinct lexeme to a stable SymbolId, so that names compare and
+// hash as integers. The table is split into shards by hash, each with its own
+// lock, so threads lexing different chunks rarely wait on each other. The
+// spellings are copied once into per-shard blocks of contiguous storage and
+// never move, so text() views stay valid for the life of the interner.
+class Interner {
+public:
+    static constexpr unsigned SHARD_BITS = 4;
+    static constexpr std::size_t SHARD_COUNT = std::size_t(1) << SHARD_BITS;
+    static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+    // The interner shared by every scanner and parser in the process.
+    static Interner& global() {
+        static Interner instance;
+        return instance;
+    }
+
+    SymbolId intern(std::string_view text) {
+        return intern(text, hashLexeme(text));
+    }
+
+    // As above, with the hash of `text` already computed by the caller.
+    SymbolId intern(std::string_view text, std::uint64_t hash) {
+        std::size_t shardIndex = hash & (SHARD_COUNT - 1);
+        Shard& shard = shards[shardIndex];
+        auto shortHash = static_cast<std::uint32_t>(hash >> 32);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if ((shard.entries.size() + 1) * 4 > shard.slots.size() * 3) {
+            grow(shard);
+        }
+        std::size_t mask = shard.slots.size() - 1;
+        for (std::size_t slot = (hash >> SHARD_BITS) & mask;; slot = (slot + 1) & mask) {
+            Slot& candidate = shard.slots[slot];
+            if (candidate.entry == 0) {
+                candidate = {shortHash, static_cast<std::uint32_t>(shard.entries.size() + 1)};
+                shard.entries.push_back(store(shard, text));
+                return makeId(shardIndex, shard.entries.size() - 1);
+            }
+            if (candidate.hash == shortHash && shard.entries[candidate.entry - 1] == text) {
+                return makeId(shardIndex, candidate.entry - 1);
+            }
+        }
+    }
+
+    // The spelling behind `id`; valid for as long as the interner lives.
+    [[nodiscard]] std::string_view text(SymbolId id) const {
+        const Shard& shard = shards[id & (SHARD_COUNT - 1)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.entries[id >> SHARD_BITS];
+    }
+
+    // Number of distinct lexemes interned so far
+    [[nodiscard]] std::size_t size() const {
+        std::size_t total = 0;
+        for (const Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.entries.size();
+        }
+        return total;
+    }
+
+    // Forgets every lexeme and frees their storage; the hash tables keep their
+    // size. Ids and text() views handed out before are meaningless afterwards,
+    // so only an owner that knows none are still in use may call this.
+    void clear() {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.entries.clear();
+            std::fill(shard.slots.begin(), shard.slots.end(), Slot{});
+            shard.blocks.clear();
+            shard.blockCursor = nullptr;
+            shard.blockLeft = 0;
+            shard.storageBytes = 0;
+        }
+    }
+
+    [[nodiscard]] std::size_t bytesUsed() const {
+        std::size_t total = 0;
+        for (const Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.entries.capacity() * sizeof(std::string_view) + shard.slots.capacity() * sizeof(Slot) +
+                     shard.storageBytes;
+        }
+        return total;
+    }
+
+private:
+    struct Slot {
+        std::uint32_t hash;   // High half of the lexeme's hash, to skip most string compares
+        std::uint32_t entry;  // Index into Shard::entries plus one; 0 marks an empty slot
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::vector<std::string_view> entries;
+        std::vector<Slot> slots;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* blockCursor = nullptr;
+        std::size_t blockLeft = 0;
+        std::size_t storageBytes = 0;
+    };
+
+    Shard shards[SHARD_COUNT];
+
+    static SymbolId makeId(std::size_t shardIndex, std::size_t entry) {
+        return static_cast<SymbolId>((entry << SHARD_BITS) | shardIndex);
+    }
+
+    // Copies `text` into the shard's current block, starting a new one when it is full.
+    static std::string_view store(Shard& shard, std::string_view text) {
+        if (text.size() > shard.blockLeft) {
+            std::size_t size = text.size() > BLOCK_SIZE ? text.size() : BLOCK_SIZE;
+            shard.blocks.emplace_back(new char[size]);
+            shard.blockCursor = shard.blocks.back().get();
+            shard.blockLeft = size;
+            shard.storageBytes += size;
+        }
+        if (!text.empty()) {
+            std::memcpy(shard.blockCursor, text.data(), text.size());
+        }
+        std::string_view stored(shard.blockCursor, text.size());
+        shard.blockCursor += text.size();
+        shard.blockLeft -= text.size();
+        return stored;
+    }
+
+    static void grow(Shard& shard) {
+        std::vector<Slot> slots(shard.slots.empty() ? 64 : shard.slots.size() * 2);
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t entry = 0; entry < shard.entries.size(); entry++) {
+            std::uint64_t hash = hashLexeme(shard.entries[entry]);
+            std::size_t slot = (hash >> SHARD_BITS) & mask;
+            while (slots[slot].entry != 0) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = {static_cast<std::uint32_t>(hash >> 32), static_cast<std::uint32_t>(entry + 1)};
+        }
+        shard.slots.swap(slots);
+    }
+};
+
+// A small direct-mapped cache in front of an Interner, owned by one thread.
+// Source code repeats the same few lexemes over and over, so most lookups are
+// answered here without hashing the whole lexeme or touching a shard lock.
+class SymbolCache {
+public:
+    static constexpr std::size_t SIZE = 256;  // lineIndex yields eight bits
+
+    explicit SymbolCache(Interner& interner = Interner::global()) : interner(&interner) {}
+
+    SymbolId intern(std::string_view text) {
+        if (text.empty()) return interner->intern(text);
+        Line& line = lines[lineIndex(text)];
+        if (line.id != NO_SYMBOL && sameText(line.text, text)) {
+            return line.id;
+        }
+        line.id = interner->intern(text);
+        line.text = interner->text(line.id);
+        return line.id;
+    }
+
+private:
+    struct Line {
+        std::string_view text;  // Points into the interner, so it never dangles
+        SymbolId id = NO_SYMBOL;
+    };
+
+    Interner* interner;
+    Line lines[SIZE];
+
+    // Lexemes are short, so a byte loop beats a call to memcmp
+    static bool sameText(std::string_view cached, std::string_view text) {
+        if (cached.size() != text.size()) return false;
+        for (std::size_t i = 0; i < text.size(); i++) {
+            if (cached[i] != text[i]) return false;
+        }
+        return true;
+    }
+
+    // Length, first and last byte tell most lexemes apart; a multiplicative
+    // hash of them picks the line.
+    static std::size_t lineIndex(std::string_view text) {
+        std::uint64_t key = text.size() | std::uint64_t(static_cast<unsigned char>(text.front())) << 16 |
+                            std::uint64_t(static_cast<unsigned char>(text.back())) << 32;
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 56);
+    }
+};
+
+#endif // INTERNER_HPP
@@ -1,19 +1,92 @@
 #ifndef KEYWORDS_HPP
 #define KEYWORDS_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
+enum class Keyword : std::uint8_t {
+    NONE,
+    INT, FLOAT, RETURN, IF, ELSE,
+    FOR, WHILE, DO, CHAR, DOUBLE,
+    STRING, LET
+};
+
+// Spellings indexed by Keyword; NONE has none.
+constexpr std::array<std::string_view, 13> KEYWORD_SPELLINGS = {
+    "",
+    "int", "float", "return", "if", "else",
+    "for", "while", "do", "char", "double",
+    "string", "let"
+};
+
+constexpr std::size_t KEYWORD_TABLE_SIZE = 32;  // Power of two, comfortably above the keyword count
+
+using KeywordTable = std::array<Keyword, KEYWORD_TABLE_SIZE>;
+
+// Length, first and last character are enough to tell the keywords apart;
+// the seed is searched for at compile time so that no two of them collide.
+constexpr std::size_t keywordHash(std::string_view word, std::size_t seed) {
+    return (word.size() + static_cast<unsigned char>(word.front()) * seed +
+            static_cast<unsigned char>(word.back())) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+constexpr bool isCollisionFree(std::size_t seed) {
+    bool used[KEYWORD_TABLE_SIZE] = {};
+    for (std::size_t i = 1; i < KEYWORD_SPELLINGS.size(); i++) {
+        std::size_t slot = keywordHash(KEYWORD_SPELLINGS[i], seed);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr std::size_t findKeywordSeed() {
+    for (std::size_t seed = 1; seed < 1024; seed++) {
+        if (isCollisionFree(seed)) return seed;
+    }
+    return 0;
+}
+
+constexpr std::size_t KEYWORD_SEED = findKeywordSeed();
+static_assert(KEYWORD_SEED != 0, "no collision-free seed; grow KEYWORD_TABLE_SIZE or hash more characters");
+
+constexpr KeywordTable buildKeywordTable() {
+    KeywordTable table{};
+    for (auto& slot : table) {
+        slot = Keyword::NONE;
+    }
+    for (std::size_t i = 1; i < KEYWORD_SPELLINGS.size(); i++) {
+        table[keywordHash(KEYWORD_SPELLINGS[i], KEYWORD_SEED)] = static_cast<Keyword>(i);
+    }
+    return table;
+}
+
+constexpr KeywordTable KEYWORD_TABLE = buildKeywordTable();
+
 class Keywords {
 public:
     static const std::vector<std::string>& getKeywords() {
-        static std::vector<std::string> keywords = {
-            "int", "float", "return", "if", "else",
-            "for", "while", "do", "char", "double",
-            "string", "let"
-        };
+        static std::vector<std::string> keywords(KEYWORD_SPELLINGS.begin() + 1, KEYWORD_SPELLINGS.end());
         return keywords;
     }
+
+    // Maps a lexeme to its keyword with one hash and at most one comparison.
+    static constexpr Keyword lookup(std::string_view word) {
+        if (word.empty()) return Keyword::NONE;
+        Keyword candidate = KEYWORD_TABLE[keywordHash(word, KEYWORD_SEED)];
+        return KEYWORD_SPELLINGS[static_cast<std::size_t>(candidate)] == word ? candidate : Keyword::NONE;
+    }
+
+    static constexpr std::string_view spelling(Keyword keyword) {
+        return KEYWORD_SPELLINGS[static_cast<std::size_t>(keyword)];
+    }
 };
 
+static_assert(Keywords::lookup("while") == Keyword::WHILE, "keyword lookup");
+static_assert(Keywords::lookup("whale") == Keyword::NONE, "non-keyword lookup");
+
 #endif // KEYWORDS_HPP
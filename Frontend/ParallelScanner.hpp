@@ -0,0 +1,118 @@
+#ifndef PARALLELSCANNER_HPP
+#define PARALLELSCANNER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Scanner.hpp"
+#include "SourceBuffer.hpp"
+
+// Lexes one source on several threads. No token spans a newline, so the
+// source is cut into chunks at line boundaries, each chunk is scanned on its
+// own thread as if it started at line 1, and the results are stitched back
+// together in chunk order with offsets and line numbers shifted into place.
+// The output is identical to a sequential Scanner::scan of the same source.
+class ParallelScanner {
+public:
+    // Chunks smaller than this are not worth a thread of their own.
+    static constexpr std::size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+    explicit ParallelScanner(unsigned threadCount = std::thread::hardware_concurrency())
+        : threadCount(std::max(1u, threadCount)) {}
+
+    std::vector<Token> scan(const SourceBuffer& source) const {
+        return scan(source.view());
+    }
+
+    std::vector<Token> scan(std::string_view source) const {
+        std::vector<Chunk> chunks = split(source);
+        if (chunks.size() == 1) {
+            int lineNumber = 1;
+            return Scanner().scan(source, lineNumber);
+        }
+
+        runPerChunk(chunks, [&](Chunk& chunk) {
+            Scanner scanner(source.substr(chunk.offset, chunk.size));
+            Token token;
+            while (scanner.nextToken(token)) {
+                chunk.tokens.push_back(token);
+            }
+            chunk.lineCount = scanner.getLineNumber() - 1;
+        });
+
+        // Each chunk's first token index and first line follow from the chunks before it
+        std::size_t tokenCount = 0;
+        int firstLine = 1;
+        for (Chunk& chunk : chunks) {
+            chunk.firstToken = tokenCount;
+            chunk.firstLine = firstLine;
+            tokenCount += chunk.tokens.size();
+            firstLine += chunk.lineCount;
+        }
+
+        std::vector<Token> tokens(tokenCount);
+        runPerChunk(chunks, [&](Chunk& chunk) {
+            Token* out = tokens.data() + chunk.firstToken;
+            for (const Token& token : chunk.tokens) {
+                *out = token;
+                out->offset += static_cast<std::uint32_t>(chunk.offset);
+                out->line += chunk.firstLine - 1;
+                ++out;
+            }
+            std::vector<Token>().swap(chunk.tokens);
+        });
+        return tokens;
+    }
+
+    [[nodiscard]] unsigned getThreadCount() const {
+        return threadCount;
+    }
+
+private:
+    struct Chunk {
+        std::size_t offset;
+        std::size_t size;
+        std::vector<Token> tokens;
+        int lineCount = 0;      // Newlines inside the chunk
+        std::size_t firstToken = 0;
+        int firstLine = 1;
+    };
+
+    unsigned threadCount;
+
+    // Roughly equal chunks, each extended to just past the next newline.
+    [[nodiscard]] std::vector<Chunk> split(std::string_view source) const {
+        std::size_t chunkCount = std::min<std::size_t>(threadCount, std::max<std::size_t>(1, source.size() / MIN_CHUNK_SIZE));
+        std::size_t target = source.size() / chunkCount;
+
+        std::vector<Chunk> chunks;
+        std::size_t begin = 0;
+        while (begin < source.size() || chunks.empty()) {
+            std::size_t end = source.size();
+            if (chunks.size() + 1 < chunkCount) {
+                std::size_t newline = source.find('\n', std::min(source.size(), begin + target));
+                if (newline != std::string_view::npos) end = newline + 1;
+            }
+            chunks.push_back({begin, end - begin, {}});
+            begin = end;
+        }
+        return chunks;
+    }
+
+    template <typename Work>
+    void runPerChunk(std::vector<Chunk>& chunks, Work work) const {
+        std::vector<std::thread> workers;
+        workers.reserve(chunks.size() - 1);
+        for (std::size_t i = 1; i < chunks.size(); i++) {
+            workers.emplace_back([&work, &chunks, i] { work(chunks[i]); });
+        }
+        work(chunks[0]);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+};
+
+#endif // PARALLELSCANNER_HPP
@@ -2,122 +2,240 @@
 #define PARSER_HPP
 
 
-#include <iostream>
-#include <stack>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
+#include "AST.hpp"
+#include "Diagnostics.hpp"
+#include "ExpressionParser.hpp"
+#include "Grammar.hpp"
 #include "Token.hpp"
+#include "TokenStream.hpp"
 
-enum class NonTerminal {S, VarDec, OptAssign, Expr};
-enum class Terminal {TYPE, IDENTIFIER, NUMBER, ASSIGN, SEMICOLON, END};
-
-inline Terminal getTerminal(const Token& token) {
+inline Terminal getTerminal(const Token& token, std::string_view source) {
+    if(token.type == TokenType::END) return Terminal::END;
     if(token.type == TokenType::KEYWORD) return Terminal::TYPE;
     if(token.type == TokenType::IDENTIFIER) return Terminal::IDENTIFIER;
     if(token.type == TokenType::NUMBER) return Terminal::NUMBER;
-    if(token.value == "=") return Terminal::ASSIGN;
-    if(token.value == ";") return Terminal::SEMICOLON;
+    if(token.text(source) == "=") return Terminal::ASSIGN;
+    if(token.text(source) == ";") return Terminal::SEMICOLON;
 
-    return Terminal::END;
+    return Terminal::UNKNOWN;
 }
 
+// Predictive LL(1) parser driven by GRAMMAR_TABLES. Nonterminals on top of the
+// explicit stack are expanded by looking up the current terminal in the parse
+// table; terminals on top must match the current token. <Expr> is handed to
+// ExpressionParser. Nothing recurses, and apart from the expression buffers,
+// which are reused, and the tree, nothing is allocated while parsing.
+//
+// The tree is built in post-order as the input is matched: leaves when their
+// tokens are, an expression's nodes straight from its postfix form, and a
+// VarDec once its ';' is, over everything matched since its type.
 class Parser {
 public:
-    explicit  Parser(const std::vector<Token>& tokens) : tokens(tokens), currentTokenIndex(0){}
-
+    // The tree is built into `storage`, whose memory is reused; takeAst()
+    // hands it back for the next parser.
+    Parser(TokenStream& tokens, std::string_view source, Ast storage = {})
+        : tokens(tokens), source(source), expressions(tokens, source, diagnostics), ast(std::move(storage)),
+          declaration(0), declarationToken(0), stackSize(0) {}
+
+    // Parses declarations until the end of the token stream. A syntax error is
+    // recorded and parsing resumes at the next declaration, so one pass finds
+    // every error. Returns whether there were none.
     bool Parse() {
-        parseStack.push(NonTerminal::S);
-
-        while(!parseStack.empty()) {
-            if(parseStack.top() == NonTerminal::S) {
-                parseStack.pop();
-                parseVarDec();
+        diagnostics.clear();
+        ast.clear();
+        ast.reserve(source.size() / AST_BYTES_PER_NODE);
+        declaration = 0;
+        stackSize = 0;
+        push(Terminal::END);
+        push(NonTerminal::S);
+
+        while(stackSize > 0) {
+            Symbol top = parseStack[--stackSize];
+            bool parsed;
+            if(top.isTerminal) {
+                parsed = match(top.terminal());
+            }else if(top.nonTerminal() == NonTerminal::Expr) {
+                parsed = expressions.parse(expression);
+                if(parsed) addExpression();
             }else {
-                if(!parseNext()) return false;
+                parsed = expand(top.nonTerminal());
             }
+            if(!parsed) recover();
         }
-        return true;
+        ast.add(AstKind::Program, tokens.position(), 0);
+        return diagnostics.empty();
     }
 
-private:
-    const std::vector<Token>& tokens;
-    int currentTokenIndex;
-    std::stack<NonTerminal> parseStack;
+    [[nodiscard]] const Diagnostics& getDiagnostics() const {
+        return diagnostics;
+    }
+
+    // The tree of the last Parse(), including the declarations that had errors
+    [[nodiscard]] const Ast& getAst() const {
+        return ast;
+    }
 
-    [[nodiscard]] Token currentToken() const {
-        return tokens[currentTokenIndex];
+    Ast takeAst() {
+        return std::move(ast);
+    }
+
+    // The last expression parsed, in post-order
+    [[nodiscard]] const std::vector<ExpressionItem>& lastExpression() const {
+        return expression;
+    }
+
+private:
+    static constexpr std::size_t MAX_STACK_DEPTH = 64;
+    static constexpr std::size_t AST_BYTES_PER_NODE = 4;  // Rough source density, to size the tree up front
+
+    TokenStream& tokens;
+    std::string_view source;
+    Diagnostics diagnostics;
+    ExpressionParser expressions;
+    std::vector<ExpressionItem> expression;
+    std::vector<AstIndex> operands;  // Subtree roots while an expression is added
+    Ast ast;
+    std::size_t declaration;  // Where the current declaration's nodes start
+    std::size_t declarationToken;
+    Symbol parseStack[MAX_STACK_DEPTH];
+    std::size_t stackSize;
+
+    [[nodiscard]] const Token& currentToken() const {
+        return tokens.peek();
     }
 
     void advance() {
-        if(currentTokenIndex<tokens.size() - 1) currentTokenIndex++;
+        tokens.next();
+    }
+
+    bool push(Symbol symbol) {
+        if(stackSize == MAX_STACK_DEPTH) {
+            diagnostics.report(currentToken(), "Nesting too deep");
+            return false;
+        }
+        parseStack[stackSize++] = symbol;
+        return true;
     }
 
     bool match(Terminal expected) {
-        if(getTerminal((currentToken())) == expected) {
+        if(getTerminal(currentToken(), source) == expected) {
+            addMatched(expected);
             advance();
             return true;
         }else {
-            std::cerr << "Syntax Error: Expected " << getTerminalName(expected) << "but got " << currentToken().value << std::endl;
+            diagnostics.report(currentToken(), "Expected " + getTerminalName(expected) + " but got " + describeCurrentToken());
             return false;
         }
     }
 
-    static std::string getTerminalName(Terminal terminal) {
+    // Replaces `nonTerminal` on the stack with the body of the production the
+    // parse table predicts for the current token.
+    bool expand(NonTerminal nonTerminal) {
+        auto row = static_cast<std::size_t>(nonTerminal);
+        auto column = static_cast<std::size_t>(getTerminal(currentToken(), source));
+        std::int8_t productionIndex = GRAMMAR_TABLES.parseTable[row][column];
+        if(productionIndex == NO_PRODUCTION) {
+            diagnostics.report(currentToken(), "Expected " + getExpectedNames(nonTerminal) + " but got " + describeCurrentToken());
+            return false;
+        }
+
+        const Production& production = GRAMMAR[productionIndex];
+        for(std::size_t i = production.length; i-- > 0;) {
+            if(!push(production.rhs[i])) return false;
+        }
+        return true;
+    }
+
+    void addMatched(Terminal terminal) {
         switch (terminal) {
-            case Terminal::TYPE: return "Type";
-            case Terminal::IDENTIFIER: return "Identifier";
-            case Terminal::ASSIGN: return "=";
-            case Terminal::NUMBER: return "Number";
-            case Terminal::SEMICOLON: return ";";
-            case Terminal::END: return "End";
-            default: return "Unknown";
+            case Terminal::TYPE:
+                declarationToken = tokens.position();
+                break;
+            case Terminal::IDENTIFIER:
+                ast.add(AstKind::Identifier, tokens.position(), ast.mark());
+                break;
+            case Terminal::SEMICOLON:
+                ast.add(AstKind::VarDec, declarationToken, declaration);
+                declaration = ast.mark();
+                break;
+            default:
+                break;
         }
     }
 
-    void parseVarDec() {
-        if(match(Terminal::TYPE)) {
-            if(match(Terminal::IDENTIFIER)) {
-                parseOptAssign();
-                match(Terminal::SEMICOLON);
+    // The postfix form is already in post-order; only each node's first
+    // descendant has to be tracked, on a stack of subtree roots.
+    void addExpression() {
+        operands.clear();
+        for(const ExpressionItem& item : expression) {
+            std::size_t from = ast.mark();
+            AstKind kind = item.token.type == TokenType::NUMBER ? AstKind::Number : AstKind::Identifier;
+            if(item.arity > 0) {
+                from = ast.view().firstNode(operands[operands.size() - item.arity]);
+                operands.resize(operands.size() - item.arity);
+                kind = item.arity == 1 ? AstKind::Unary : AstKind::Binary;
             }
+            operands.push_back(ast.add(kind, item.position, from));
         }
     }
 
-    void parseOptAssign() {
-        if(getTerminal(currentToken()) == Terminal::ASSIGN) {
-            match(Terminal::ASSIGN);
-            parseExpr();
+    // Panic mode: drop the rest of the current declaration from the stack and
+    // skip input to where the next one can start: just past a ';', or at a
+    // type keyword or the end of input. Each error consumes at least one
+    // token between here and the previous recovery, so this always ends.
+    void recover() {
+        ast.add(AstKind::Error, tokens.position(), declaration);
+        declaration = ast.mark();
+
+        while(stackSize > 0) {
+            Symbol top = parseStack[stackSize - 1];
+            if(!top.isTerminal && top.nonTerminal() == NonTerminal::S) break;
+            if(top.isTerminal && top.terminal() == Terminal::END) {
+                push(NonTerminal::S);  // The failed symbol was the declaration list itself
+                break;
+            }
+            stackSize--;
         }
-    }
 
-    void parseExpr() {
-        Terminal termType = getTerminal(currentToken());
-        if(termType == Terminal::IDENTIFIER || termType == Terminal::NUMBER) {
+        while(true) {
+            Terminal terminal = getTerminal(currentToken(), source);
+            if(terminal == Terminal::END || terminal == Terminal::TYPE) break;
             advance();
-        }else {
-            std::cerr << "Syntax Error: Expected identifier or numer" << std::endl;
+            if(terminal == Terminal::SEMICOLON) break;
         }
     }
 
-    bool parseNext() {
-        NonTerminal top = parseStack.top();
-        parseStack.pop();
+    [[nodiscard]] std::string describeCurrentToken() const {
+        if(currentToken().type == TokenType::END) return "end of input";
+        return std::string(currentToken().text(source));
+    }
 
-        switch (top) {
-            case NonTerminal::VarDec:
-                parseVarDec();
-                break;
-            case NonTerminal::OptAssign:
-                parseOptAssign();
-                break;
-            case NonTerminal::Expr:
-                parseExpr();
-                break;
-            default:
-                std::cerr << "Syntax Error: Unexpected Item" << std::endl;
-            return false;
+    static std::string getTerminalName(Terminal terminal) {
+        switch (terminal) {
+            case Terminal::TYPE: return "Type";
+            case Terminal::IDENTIFIER: return "Identifier";
+            case Terminal::ASSIGN: return "=";
+            case Terminal::NUMBER: return "Number";
+            case Terminal::SEMICOLON: return ";";
+            case Terminal::UNKNOWN: return "Unknown";
+            case Terminal::END: return "End";
+            default: return "Unknown";
         }
+    }
 
-        return true;
+    // The terminals that could start `nonTerminal` here, e.g. "Identifier or Number"
+    static std::string getExpectedNames(NonTerminal nonTerminal) {
+        std::string names;
+        for(std::size_t t = 0; t < TERMINAL_COUNT; t++) {
+            if(GRAMMAR_TABLES.parseTable[static_cast<std::size_t>(nonTerminal)][t] == NO_PRODUCTION) continue;
+            if(!names.empty()) names += " or ";
+            names += getTerminalName(static_cast<Terminal>(t));
+        }
+        return names;
     }
 
 };
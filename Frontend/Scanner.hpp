@@ -1,96 +1,151 @@
 #ifndef SCANNER_HPP
 #define SCANNER_HPP
 
+#include <cctype>
+#include <string_view>
 #include <vector>
-#include <algorithm>
 #include "Token.hpp"
+#include "ByteClassifier.hpp"
 #include "Keywords.hpp"
 #include "DFA.hpp"
+#include "Interner.hpp"
+#include "SourceBuffer.hpp"
+#include "TokenStream.hpp"
 
 
-class Scanner {
+class Scanner : public TokenSource {
 public:
     Scanner() : dfa() {}
-    std::vector<Token> scan(const std::string& line, int& lineNumber) {
-        std::vector<Token> tokens;
-        std::string tokenValue;
-        dfa.reset();
 
-        for (char ch : line) {
-            if (std::isspace(ch)) {
-                if (!tokenValue.empty()) {
-                    Token token = processToken(tokenValue, lineNumber);
-                    tokens.push_back(token);
-                    tokenValue.clear();
-                }
-                dfa.reset();
-                continue;
-            }
+    // Prepares to hand out the tokens of `source` lazily through nextToken.
+    // Token offsets and columns are relative to `source`, which must outlive them.
+    explicit Scanner(std::string_view source, int firstLine = 1) : dfa() {
+        setSource(source, firstLine);
+    }
 
-            // Check if the character is a delimiter first
-            if (dfa.isDelimiterChar(ch)) {
-                if (!tokenValue.empty()) {
-                    Token token = processToken(tokenValue, lineNumber);
-                    tokens.push_back(token);
-                    tokenValue.clear();
-                }
-
-                Token token = processToken(std::string(1, ch), lineNumber, TokenType::DELIMITER);
-                tokens.push_back(token);
-                dfa.reset();
-                continue;
-            }
+    void setSource(std::string_view source, int firstLine = 1) {
+        rangeBegin = source.data();
+        rangeEnd = source.data() + source.size();
+        cursor = rangeBegin;
+        lineStart = rangeBegin;
+        currentLine = firstLine;
+    }
+
+    // Interns names and literals into `interner` instead of the global one
+    void setInterner(Interner& interner) {
+        symbols = SymbolCache(interner);
+    }
 
-            // Transition the DFA with the current character
-            dfa.transition(ch);
-            tokenValue += ch;
-
-            // Process token if DFA reaches a final state
-            if (dfa.getCurrentState() == State::DONE) {
-                // Determine the token type based on the last recognized state
-                TokenType type = identifyTokenType(tokenValue);
-                Token token = {type, tokenValue, lineNumber};
-                tokens.push_back(token);
-                tokenValue.clear();
-                dfa.reset();
+    // Scans a single line (or any run of text starting at `lineNumber`);
+    // token offsets and columns are relative to `line`.
+    std::vector<Token> scan(std::string_view line, int& lineNumber) {
+        setSource(line, lineNumber);
+        std::vector<Token> tokens = scanAll();
+        lineNumber = currentLine;
+        return tokens;
+    }
+
+    // Scans a whole source buffer in one pass, counting lines as it crosses them.
+    // The returned tokens point into `source`, which must outlive them.
+    std::vector<Token> scan(const SourceBuffer& source) {
+        setSource(source.view());
+        return scanAll();
+    }
+
+    // The line the scanner has reached so far
+    [[nodiscard]] int getLineNumber() const {
+        return currentLine;
+    }
+
+    // Produces the next token, consuming only as much input as that token needs.
+    // Tokens are the longest match (maximal munch): the DFA runs until a byte
+    // cannot extend the token, and the scanner then backs up to the last
+    // position where the bytes read formed a whole token. That is at most one
+    // byte back, so every byte is looked at a bounded number of times.
+    bool nextToken(Token& token) override {
+        while (cursor != rangeEnd && std::isspace(static_cast<unsigned char>(*cursor))) {
+            if (*cursor == '\n') {
+                currentLine++;
+                lineStart = cursor + 1;
+                ++cursor;
+            } else {
+                cursor = ByteClassifier::skipRun(ByteRun::BLANK, cursor + 1, rangeEnd);
             }
         }
+        if (cursor == rangeEnd) return false;
 
-        // Handle any remaining token at the end of the line
-        if (!tokenValue.empty()) {
-            Token token = processToken(tokenValue, lineNumber);
-            tokens.push_back(token);
+        // Check if the character is a delimiter first
+        if (dfa.isDelimiterChar(*cursor)) {
+            token = processToken(cursor, cursor + 1, TokenType::DELIMITER);
+            ++cursor;
+            return true;
         }
 
-        return tokens;
-    }
+        const char* tokenStart = cursor;
+        const char* acceptEnd = cursor;  // End of the longest token seen so far
+        State acceptState = State::START;
+        dfa.reset();
+        while (cursor != rangeEnd) {
+            State state = dfa.transition(*cursor);
+            if (state == State::DONE) break;
+            ++cursor;
+
+            // The DFA loops on letters and digits; skip such runs in bulk and
+            // only feed it the byte that ends the run
+            if (state == State::IN_KEYWORD) {
+                cursor = ByteClassifier::skipRun(ByteRun::WORD, cursor, rangeEnd);
+            } else if (state == State::IN_NUMBER || state == State::IN_FRACTION) {
+                cursor = ByteClassifier::skipRun(ByteRun::DIGIT, cursor, rangeEnd);
+            }
 
+            if (DFA::isAccepting(state)) {
+                acceptEnd = cursor;
+                acceptState = state;
+            }
+        }
+
+        // Hand back what was read past the longest token, e.g. the '.' of "12."
+        cursor = acceptEnd;
+        std::string_view value(tokenStart, static_cast<std::size_t>(acceptEnd - tokenStart));
+        token = processToken(tokenStart, acceptEnd, identifyTokenType(value, acceptState));
+        return true;
+    }
 
 private:
     DFA dfa;
-
-    Token processToken(const std::string& value, int line, TokenType typeOverride = TokenType::KEYWORD) {
-        TokenType type;
-
-        if (typeOverride == TokenType::KEYWORD) {
-            type = identifyTokenType(value);
-        } else {
-            type = typeOverride;
+    SymbolCache symbols;
+    const char* rangeBegin = nullptr;  // Token offsets are relative to this
+    const char* rangeEnd = nullptr;
+    const char* cursor = nullptr;
+    const char* lineStart = nullptr;   // Token columns are relative to this
+    int currentLine = 1;
+
+    std::vector<Token> scanAll() {
+        std::vector<Token> tokens;
+        Token token;
+        while (nextToken(token)) {
+            tokens.push_back(token);
         }
+        return tokens;
+    }
+
+    Token processToken(const char* start, const char* stop, TokenType type) {
+        std::string_view value(start, static_cast<std::size_t>(stop - start));
 
-        return {type, value, line};
+        // Names and literals are interned; punctuation and keywords are told apart by type and text
+        SymbolId symbol = type == TokenType::IDENTIFIER || type == TokenType::NUMBER ? symbols.intern(value) : NO_SYMBOL;
+        return {type, static_cast<std::uint32_t>(start - rangeBegin), static_cast<std::uint32_t>(value.size()),
+                currentLine, static_cast<int>(start - lineStart) + 1, symbol};
     }
 
-    TokenType identifyTokenType(const std::string& value) {
-        // Use the state of the DFA to identify the token type
-        switch (dfa.getCurrentState()) {
+    // The type of a token the DFA accepted in `state`
+    static TokenType identifyTokenType(std::string_view value, State state) {
+        switch (state) {
             case State::IN_KEYWORD:
-                if (isKeyword(value)) {
-                    return TokenType::KEYWORD;
-                }
-            break;
+                return isKeyword(value) ? TokenType::KEYWORD : TokenType::IDENTIFIER;
 
             case State::IN_NUMBER:
+            case State::IN_FRACTION:
                 return TokenType::NUMBER;
 
             case State::IN_OPERATOR:
@@ -100,13 +155,12 @@ private:
                 return TokenType::DELIMITER;
 
             default:
-                break;
+                return TokenType::UNKNOWN;
         }
-        return TokenType::IDENTIFIER;
     }
 
-    static bool isKeyword(const std::string& value) {
-        return std::find(Keywords::getKeywords().begin(), Keywords::getKeywords().end(), value) != Keywords::getKeywords().end();
+    static bool isKeyword(std::string_view value) {
+        return Keywords::lookup(value) != Keyword::NONE;
     }
 
 };
@@ -0,0 +1,248 @@
+#ifndef SOURCEBUFFER_HPP
+#define SOURCEBUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The whole source file as one contiguous, read-only block of bytes.
+// Regular files are memory-mapped so the scanner reads straight out of the page
+// cache; anything that cannot be mapped (pipes, stdin, empty files) is read
+// into a single owned buffer instead.
+class SourceBuffer {
+public:
+    // Tokens and the caches store offsets in 32 bits, so a longer source
+    // would have them wrap instead of failing
+    static constexpr std::size_t MAX_SOURCE_SIZE = UINT32_MAX;
+
+    SourceBuffer() = default;
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    SourceBuffer(SourceBuffer&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            owned = std::move(other.owned);
+            error = std::move(other.error);
+            mappedData = other.mappedData;
+            mappedSize = other.mappedSize;
+#ifdef _WIN32
+            mappingHandle = other.mappingHandle;
+            other.mappingHandle = nullptr;
+#endif
+            other.mappedData = nullptr;
+            other.mappedSize = 0;
+        }
+        return *this;
+    }
+
+    ~SourceBuffer() {
+        release();
+    }
+
+    // Loads `path`, or standard input when `path` is "-". Fails when it
+    // cannot be read or holds more than `maxSize` bytes; getError says which.
+    bool open(const std::string& path, std::size_t maxSize = MAX_SOURCE_SIZE) {
+        release();
+        sizeLimit = maxSize;
+        tooLarge = false;
+        error.clear();
+        bool ok = path == "-" ? openStdin() : mapFile(path);
+        if (!ok) {
+            release();
+            error = "Could not open " + (path == "-" ? std::string("standard input") : "the file " + path);
+            if (tooLarge) error += ": it is over " + std::to_string(maxSize) + " bytes long";
+        }
+        return ok;
+    }
+
+    // Why the last open() failed, or empty when it did not
+    [[nodiscard]] const std::string& getError() const {
+        return error;
+    }
+
+    [[nodiscard]] const char* data() const {
+        return mappedData ? mappedData : owned.data();
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return mappedData ? mappedSize : owned.size();
+    }
+
+    [[nodiscard]] std::string_view view() const {
+        return {data(), size()};
+    }
+
+    [[nodiscard]] bool isMapped() const {
+        return mappedData != nullptr;
+    }
+
+private:
+    std::string owned;
+    const char* mappedData = nullptr;
+    std::size_t mappedSize = 0;
+    std::size_t sizeLimit = MAX_SOURCE_SIZE;
+    bool tooLarge = false;
+    std::string error;
+#ifdef _WIN32
+    HANDLE mappingHandle = nullptr;
+#endif
+
+#ifdef _WIN32
+    bool openStdin() {
+        char chunk[1 << 16];
+        while (std::cin.read(chunk, sizeof(chunk)) || std::cin.gcount() > 0) {
+            owned.append(chunk, static_cast<std::size_t>(std::cin.gcount()));
+            if (owned.size() > sizeLimit) {
+                tooLarge = true;
+                return false;
+            }
+        }
+        return !std::cin.bad();
+    }
+
+    bool mapFile(const std::string& path) {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        bool sized = GetFileType(file) == FILE_TYPE_DISK && GetFileSizeEx(file, &fileSize);
+        if (sized && static_cast<std::uint64_t>(fileSize.QuadPart) > sizeLimit) {
+            CloseHandle(file);
+            tooLarge = true;
+            return false;
+        }
+        if (sized && fileSize.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (view) {
+                    CloseHandle(file);
+                    mappingHandle = mapping;
+                    mappedData = static_cast<const char*>(view);
+                    mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+                    return true;
+                }
+                CloseHandle(mapping);
+            }
+        }
+
+        char chunk[1 << 16];
+        DWORD bytesRead = 0;
+        bool ok = true;
+        while ((ok = ReadFile(file, chunk, sizeof(chunk), &bytesRead, nullptr)) && bytesRead > 0) {
+            owned.append(chunk, bytesRead);
+            if (owned.size() > sizeLimit) {
+                tooLarge = true;
+                ok = false;
+                break;
+            }
+        }
+        CloseHandle(file);
+        return ok;
+    }
+
+    void release() {
+        if (mappedData) {
+            UnmapViewOfFile(mappedData);
+            CloseHandle(mappingHandle);
+            mappingHandle = nullptr;
+        }
+        mappedData = nullptr;
+        mappedSize = 0;
+        owned.clear();
+    }
+#else
+    bool openStdin() {
+        // Stdin redirected from a file can still be mapped; a pipe cannot.
+        return mapDescriptor(STDIN_FILENO) || (!tooLarge && readDescriptor(STDIN_FILENO));
+    }
+
+    bool mapFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        bool ok = mapDescriptor(fd) || (!tooLarge && readDescriptor(fd));
+        ::close(fd);
+        return ok;
+    }
+
+    bool mapDescriptor(int fd) {
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            return false;
+        }
+        if (static_cast<std::uint64_t>(info.st_size) > sizeLimit) {
+            tooLarge = true;
+            return false;
+        }
+        if (info.st_size > 0) {
+            void* mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+                mappedData = static_cast<const char*>(mapping);
+                mappedSize = static_cast<std::size_t>(info.st_size);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readDescriptor(int fd) {
+        char chunk[1 << 16];
+        while (true) {
+            ssize_t bytesRead = ::read(fd, chunk, sizeof(chunk));
+            if (bytesRead == 0) return true;
+            if (bytesRead < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            owned.append(chunk, static_cast<std::size_t>(bytesRead));
+            if (owned.size() > sizeLimit) {
+                tooLarge = true;
+                return false;
+            }
+        }
+    }
+
+    void release() {
+        if (mappedData) {
+            munmap(const_cast<char*>(mappedData), mappedSize);
+        }
+        mappedData = nullptr;
+        mappedSize = 0;
+        owned.clear();
+    }
+#endif
+};
+
+#endif // SOURCEBUFFER_HPP
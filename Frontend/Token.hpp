@@ -1,25 +1,44 @@
 #ifndef TOKEN_HPP
 #define TOKEN_HPP
 
+#include <cstdint>
 #include <string>
-#include <utility>
+#include <string_view>
+#include "Interner.hpp"
 
-enum class TokenType {
+enum class TokenType : std::uint8_t {
     IDENTIFIER,
     KEYWORD,
     NUMBER,
     OPERATOR,
     DELIMITER,
+    UNKNOWN,    // A byte that starts no token
+    END,        // Past the last token of the input
 };
 
+// A token does not own its text: it records where the lexeme sits in the
+// source buffer it was scanned from, and that buffer must outlive it.
+// Identifiers and numbers also carry their interned symbol, which identifies
+// the spelling without looking at the source.
 class Token {
 public:
     TokenType type;
-    std::string value;
+    std::uint32_t offset;
+    std::uint32_t length;
     int line;
+    int column;
+    SymbolId symbol;  // Same lexeme, same symbol; NO_SYMBOL for other types
 
-    Token(TokenType type, std::string  value, int line)
-        : type(type), value(std::move(value)), line(line) {}
+    Token() : Token(TokenType::END, 0, 0, 0, 0) {}
+
+    Token(TokenType type, std::uint32_t offset, std::uint32_t length, int line, int column,
+          SymbolId symbol = NO_SYMBOL)
+        : type(type), offset(offset), length(length), line(line), column(column), symbol(symbol) {}
+
+    // The lexeme, given the source the token was scanned from
+    [[nodiscard]] std::string_view text(std::string_view source) const {
+        return source.substr(offset, length);
+    }
 
     // Method to return a string representation of the token type
     [[nodiscard]] std::string getTypeAsString() const {
@@ -29,9 +48,13 @@ public:
             case TokenType::NUMBER: return "NUMBER";
             case TokenType::OPERATOR: return "OPERATOR";
             case TokenType::DELIMITER: return "DELIMITER";
+            case TokenType::UNKNOWN: return "UNKNOWN";
+            case TokenType::END: return "END";
             default: return "UNKNOWN";
         }
     }
 };
 
+static_assert(sizeof(Token) <= 24, "tokens are meant to stay compact");
+
 #endif // TOKEN_HPP
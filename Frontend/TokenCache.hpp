@@ -0,0 +1,215 @@
+#ifndef TOKENCACHE_HPP
+#define TOKENCACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Interner.hpp"
+#include "SourceBuffer.hpp"
+#include "Token.hpp"
+#include "TokenStream.hpp"
+
+// A .tok file holds the token stream of one source so that a later run can
+// skip lexing it: a header, then one fixed-size record per token in source
+// order, in the byte order of the machine that wrote it. Bump the version
+// whenever the layout or the way sources are tokenized changes.
+constexpr char TOKEN_CACHE_MAGIC[8] = {'H', 'U', 'T', 'T', 'O', 'K', '\r', '\n'};
+constexpr std::uint32_t TOKEN_CACHE_VERSION = 1;
+
+struct TokenCacheHeader {
+    char magic[8];
+    std::uint32_t version;     // Also reads wrong on a machine of the other byte order
+    std::uint32_t recordSize;
+    std::uint64_t sourceHash;
+    std::uint64_t sourceSize;
+    std::uint64_t tokenCount;
+};
+
+// Columns are not stored: the loader recovers them from the source, since
+// only whitespace separates a line's first token from the newline before it.
+// Symbols are process-local, so the loader interns names and literals again.
+struct TokenRecord {
+    std::uint32_t offset;
+    std::uint32_t length;
+    std::uint32_t line;
+    TokenType type;
+};
+
+static_assert(sizeof(TokenCacheHeader) == 40, "the header layout is part of the format");
+static_assert(sizeof(TokenRecord) == 16, "the record layout is part of the format");
+
+// Identifies a source by content, not by name or timestamp. A fast 64-bit
+// hash, not a cryptographic digest; see CachedTokenSource::open.
+inline std::uint64_t hashSource(std::string_view source) {
+    return hashLexeme(source);
+}
+
+// Where the token cache of `sourcePath` lives
+inline std::string tokenCachePath(const std::string& sourcePath) {
+    return sourcePath + ".tok";
+}
+
+// Writes `parts` one after another to `path`. They go to a temporary file
+// first, which is renamed into place, so a reader never sees half a file and
+// concurrent writers of the same path each leave a whole one.
+inline bool replaceFile(const std::string& path, std::initializer_list<std::string_view> parts) {
+    std::size_t unique = std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+                         static_cast<std::size_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::string temporaryPath = path + ".tmp" + std::to_string(unique);
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        for (std::string_view part : parts) {
+            out.write(part.data(), static_cast<std::streamsize>(part.size()));
+        }
+        if (!out.flush()) {
+            out.close();
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(path.c_str());  // rename() does not replace an existing file everywhere
+        if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+inline std::vector<TokenRecord> makeTokenRecords(const std::vector<Token>& tokens) {
+    std::vector<TokenRecord> records;
+    records.reserve(tokens.size());
+    for (const Token& token : tokens) {
+        TokenRecord record{};
+        record.offset = token.offset;
+        record.length = token.length;
+        record.line = static_cast<std::uint32_t>(token.line);
+        record.type = token.type;
+        records.push_back(record);
+    }
+    return records;
+}
+
+// Writes the tokens of `source` to `path`.
+inline bool writeTokenCache(const std::string& path, const std::vector<Token>& tokens, std::string_view source) {
+    TokenCacheHeader header{};
+    std::memcpy(header.magic, TOKEN_CACHE_MAGIC, sizeof(header.magic));
+    header.version = TOKEN_CACHE_VERSION;
+    header.recordSize = sizeof(TokenRecord);
+    header.sourceHash = hashSource(source);
+    header.sourceSize = source.size();
+    header.tokenCount = tokens.size();
+
+    std::vector<TokenRecord> records = makeTokenRecords(tokens);
+    return replaceFile(path, {{reinterpret_cast<const char*>(&header), sizeof(header)},
+                              {reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TokenRecord)}});
+}
+
+// Replays a token cache through the TokenSource interface, so it feeds the
+// parser exactly as a Scanner over the same source would. The file is
+// memory-mapped and records are decoded one at a time as they are pulled.
+class CachedTokenSource : public TokenSource {
+public:
+    CachedTokenSource() = default;
+
+    // Maps the cache at `path`. Fails, leaving nothing to replay, when the file
+    // is missing, malformed, from another format version or written for a
+    // source whose size or 64-bit hashSource differs from `source`'s. The hash
+    // is not cryptographic: two sources of one size that collide would share
+    // a cache, which is unlikely by accident but easy to arrange on purpose.
+    bool open(const std::string& path, std::string_view source) {
+        replay(nullptr, 0, source);
+        // Not held to the source limit: 16 bytes a token can outgrow it
+        if (!file.open(path, SIZE_MAX) || file.size() < sizeof(TokenCacheHeader)) return false;
+
+        TokenCacheHeader header{};
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, TOKEN_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != TOKEN_CACHE_VERSION || header.recordSize != sizeof(TokenRecord) ||
+            header.sourceSize != source.size() ||
+            header.tokenCount != (file.size() - sizeof(header)) / sizeof(TokenRecord) ||
+            header.sourceHash != hashSource(source)) {
+            return false;
+        }
+
+        replay(file.data() + sizeof(header), static_cast<std::size_t>(header.tokenCount), source);
+        return true;
+    }
+
+    // Replays `count` records that are already in memory, such as the token
+    // section of an AST cache entry, from the first.
+    void replay(const char* records, std::size_t count, std::string_view source) {
+        this->records = records;
+        this->count = count;
+        this->source = source;
+        index = 0;
+        previousEnd = 0;
+        line = 0;
+        lineStart = 0;
+    }
+
+    // Interns names and literals into `interner` instead of the global one
+    void setInterner(Interner& interner) {
+        symbols = SymbolCache(interner);
+    }
+
+    // Number of tokens in the cache
+    [[nodiscard]] std::size_t size() const {
+        return count;
+    }
+
+    bool nextToken(Token& token) override {
+        if (index == count) return false;
+        TokenRecord record;
+        std::memcpy(&record, records + index * sizeof(TokenRecord), sizeof(record));
+        index++;
+        // Damaged past the header: stop rather than read outside the source,
+        // or work out lines and columns from tokens out of order
+        if (record.offset > source.size() || record.length > source.size() - record.offset ||
+            record.offset < previousEnd || static_cast<int>(record.line) < line) {
+            index = count;
+            return false;
+        }
+
+        if (static_cast<int>(record.line) != line) {
+            // The newline ending the previous line is in the whitespace just before this token
+            lineStart = record.offset;
+            while (lineStart > previousEnd && source[lineStart - 1] != '\n') {
+                lineStart--;
+            }
+            line = static_cast<int>(record.line);
+        }
+        previousEnd = record.offset + record.length;
+
+        SymbolId symbol = NO_SYMBOL;
+        if (record.type == TokenType::IDENTIFIER || record.type == TokenType::NUMBER) {
+            symbol = symbols.intern(source.substr(record.offset, record.length));
+        }
+        token = Token(record.type, record.offset, record.length, line,
+                      static_cast<int>(record.offset - lineStart) + 1, symbol);
+        return true;
+    }
+
+private:
+    SourceBuffer file;
+    std::string_view source;
+    const char* records = nullptr;
+    std::size_t count = 0;
+    std::size_t index = 0;
+    std::uint32_t previousEnd = 0;
+    std::uint32_t lineStart = 0;
+    int line = 0;
+    SymbolCache symbols;
+};
+
+#endif // TOKENCACHE_HPP
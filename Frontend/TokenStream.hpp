@@ -0,0 +1,91 @@
+#ifndef TOKENSTREAM_HPP
+#define TOKENSTREAM_HPP
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include "Token.hpp"
+
+// Anything that can hand out tokens one at a time, in source order.
+class TokenSource {
+public:
+    virtual ~TokenSource() = default;
+
+    // Stores the next token in `token`; returns false once the input is exhausted.
+    virtual bool nextToken(Token& token) = 0;
+};
+
+// Replays tokens that were already materialized, e.g. for a token listing.
+class VectorTokenSource : public TokenSource {
+public:
+    explicit VectorTokenSource(const std::vector<Token>& tokens) : tokens(tokens), index(0) {}
+
+    bool nextToken(Token& token) override {
+        if (index == tokens.size()) return false;
+        token = tokens[index++];
+        return true;
+    }
+
+private:
+    const std::vector<Token>& tokens;
+    std::size_t index;
+};
+
+// Pulls tokens from a TokenSource on demand and keeps only the lookahead
+// window in a fixed ring buffer, so memory does not grow with the input.
+// Past the end of the input every peek/next yields a TokenType::END token.
+class TokenStream {
+public:
+    static constexpr std::size_t LOOKAHEAD = 4;  // Power of two
+
+    explicit TokenStream(TokenSource& source) : source(source), head(0), count(0), consumed(0), exhausted(false) {}
+
+    // The k-th token ahead of the current position; peek(0) is the current token.
+    const Token& peek(std::size_t k = 0) {
+        assert(k < LOOKAHEAD);
+        while (count <= k && !exhausted) {
+            Token& slot = buffer[(head + count) & (LOOKAHEAD - 1)];
+            if (source.nextToken(slot)) {
+                count++;
+                // The END token sits just past the last real token so diagnostics point there
+                endToken = Token(TokenType::END, slot.offset + slot.length, 0, slot.line,
+                                 slot.column + static_cast<int>(slot.length));
+            } else {
+                exhausted = true;
+            }
+        }
+        return k < count ? buffer[(head + k) & (LOOKAHEAD - 1)] : endToken;
+    }
+
+    // Consumes and returns the current token.
+    Token next() {
+        Token token = peek(0);
+        if (count > 0) {
+            head = (head + 1) & (LOOKAHEAD - 1);
+            count--;
+            consumed++;
+        }
+        return token;
+    }
+
+    // Index of the current token in source order; at the end, the number of tokens.
+    [[nodiscard]] std::size_t position() const {
+        return consumed;
+    }
+
+    [[nodiscard]] bool atEnd() {
+        return peek(0).type == TokenType::END;
+    }
+
+private:
+    TokenSource& source;
+    std::array<Token, LOOKAHEAD> buffer{};
+    std::size_t head;
+    std::size_t count;
+    std::size_t consumed;
+    bool exhausted;
+    Token endToken{TokenType::END, 0, 0, 1, 1};
+};
+
+#endif // TOKENSTREAM_HPP
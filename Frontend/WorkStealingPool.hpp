@@ -0,0 +1,93 @@
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs a fixed set of independent tasks on a few threads. Each worker starts
+// with a contiguous share of the tasks in its own deque and takes them from
+// the back; a worker that runs out steals from the front of another's, the
+// end its owner reaches last. Tasks vary in cost (file sizes differ by orders
+// of magnitude), so stealing keeps every thread busy until all are done
+// without a shared queue that every task would contend on.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threadCount = std::thread::hardware_concurrency())
+        : threadCount(std::max(1u, threadCount)) {}
+
+    // Calls work(task, worker) once for every task in [0, taskCount), where
+    // worker in [0, getThreadCount()) identifies the calling thread, so the
+    // caller can keep per-thread state. Returns when every task has run.
+    template <typename Work>
+    void run(std::size_t taskCount, Work work) const {
+        std::size_t workerCount = std::min<std::size_t>(threadCount, std::max<std::size_t>(1, taskCount));
+        std::vector<std::unique_ptr<Queue>> queues;
+        for (std::size_t w = 0; w < workerCount; w++) {
+            queues.push_back(std::make_unique<Queue>());
+            // The first tasks end up at the back, so each worker goes through its share in order
+            for (std::size_t task = taskCount * (w + 1) / workerCount; task-- > taskCount * w / workerCount;) {
+                queues[w]->tasks.push_back(task);
+            }
+        }
+
+        auto loop = [&](std::size_t worker) {
+            std::size_t task;
+            while (queues[worker]->popBack(task) || steal(queues, worker, task)) {
+                work(task, worker);
+            }
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(workerCount - 1);
+        for (std::size_t w = 1; w < workerCount; w++) {
+            workers.emplace_back(loop, w);
+        }
+        loop(0);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    [[nodiscard]] unsigned getThreadCount() const {
+        return threadCount;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+
+        bool popBack(std::size_t& task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty()) return false;
+            task = tasks.back();
+            tasks.pop_back();
+            return true;
+        }
+
+        bool popFront(std::size_t& task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty()) return false;
+            task = tasks.front();
+            tasks.pop_front();
+            return true;
+        }
+    };
+
+    unsigned threadCount;
+
+    // No task is ever added, so once a sweep over the other queues finds
+    // them all empty there is nothing left to steal.
+    static bool steal(std::vector<std::unique_ptr<Queue>>& queues, std::size_t thief, std::size_t& task) {
+        for (std::size_t i = 1; i < queues.size(); i++) {
+            if (queues[(thief + i) % queues.size()]->popFront(task)) return true;
+        }
+        return false;
+    }
+};
+
+#endif // WORKSTEALINGPOOL_HPP
@@ -0,0 +1,117 @@
+// Tree building in the 401130253 syntax analyzer: nodes in an ASTArena, as
+// the parser makes them now, against one make_shared node per tree node with
+// its own value string and child vector, as it used to. Reports nodes per
+// second and the heap bytes each node keeps alive, as ASTArena::bytesUsed
+// gives them for the arena and a counting allocator for the shared nodes.
+//
+// Usage: ArenaBench [terms in the printed sum, default 1000000]
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Frontend/401130253/تحلیلگر نحوی.cpp"
+#include "Bench.hpp"
+
+// Counts what the shared_ptr tree allocates: its nodes with their control
+// blocks, their value strings and their child vectors. The arena reports its
+// own bytes, so nothing global has to be replaced.
+static std::size_t sharedBytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(std::size_t count) {
+        sharedBytes += count * sizeof(T);
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T* pointer, std::size_t count) {
+        sharedBytes -= count * sizeof(T);
+        std::allocator<T>().deallocate(pointer, count);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const {
+        return false;
+    }
+};
+
+struct SharedNode {
+    basic_string<char, char_traits<char>, CountingAllocator<char>> value;
+    vector<shared_ptr<SharedNode>, CountingAllocator<shared_ptr<SharedNode>>> children;
+    explicit SharedNode(string_view value) : value(value.data(), value.size()) {}
+};
+
+// The arena makes children before their parents, so rebuilding its tree in
+// id order allocates shared nodes in the order the old parser did.
+shared_ptr<SharedNode> buildShared(const ASTArena& arena, NodeId root) {
+    vector<shared_ptr<SharedNode>> built(arena.size());
+    for (NodeId id = 0; id < arena.size(); id++) {
+        auto node = allocate_shared<SharedNode>(CountingAllocator<SharedNode>(), arena.value(id));
+        for (size_t i = 0; i < arena.childCount(id); i++) {
+            node->children.push_back(std::move(built[arena.child(id, i)]));
+        }
+        built[id] = std::move(node);
+    }
+    return built[root];
+}
+
+// Unlinks the tree a node at a time; letting the root go would free a long
+// operator chain by recursing once per level.
+void releaseShared(shared_ptr<SharedNode> root) {
+    vector<shared_ptr<SharedNode>> pending;
+    pending.push_back(std::move(root));
+    while (!pending.empty()) {
+        shared_ptr<SharedNode> node = std::move(pending.back());
+        pending.pop_back();
+        for (auto& child : node->children) {
+            pending.push_back(std::move(child));
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t terms = countArgument(argc, argv, 1000000);
+    string program = "Program Var a; Start Print(a";
+    for (std::size_t i = 1; i < terms; i++) {
+        program += i % 2 ? " + a" : " - 7";
+    }
+    program += "); End";
+    LexicalAnalyzer lexer;
+    lexer.analyze(program);
+
+    ASTArena arena;
+    NodeId root = NO_NODE;
+    double arenaSeconds = measureSeconds([&] {
+        Parser parser(lexer.getTokens(), arena);
+        root = parser.parse();
+    });
+    double nodes = static_cast<double>(arena.size());
+    double arenaBytes = static_cast<double>(arena.bytesUsed());
+
+    shared_ptr<SharedNode> sharedRoot;
+    double sharedSeconds = measureSeconds([&] { sharedRoot = buildShared(arena, root); });
+    double sharedNodeBytes = static_cast<double>(sharedBytes);
+
+    std::printf("%.0f nodes\n", nodes);
+    std::printf("arena       %7.2fM nodes/s  %6.1f bytes/node  (parse included)\n",
+                nodes / arenaSeconds / 1e6, arenaBytes / nodes);
+    std::printf("shared_ptr  %7.2fM nodes/s  %6.1f bytes/node  (allocation only)\n",
+                nodes / sharedSeconds / 1e6, sharedNodeBytes / nodes);
+    releaseShared(std::move(sharedRoot));
+    return 0;
+}
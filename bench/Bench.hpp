@@ -0,0 +1,35 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+
+// Wall-clock seconds taken by one call of `work`.
+template <typename Work>
+double measureSeconds(Work&& work) {
+    auto start = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The best of `rounds` timings, which is the least disturbed by the rest of the machine.
+template <typename Work>
+double bestSeconds(int rounds, Work&& work) {
+    double best = measureSeconds(work);
+    for (int round = 1; round < rounds; round++) {
+        double seconds = measureSeconds(work);
+        if (seconds < best) best = seconds;
+    }
+    return best;
+}
+
+// Results are folded into this so the compiler cannot drop the work that made them.
+inline volatile std::size_t benchSink = 0;
+
+// The first command-line argument as a count, or `fallback` when there is none.
+inline std::size_t countArgument(int argc, char* argv[], std::size_t fallback) {
+    return argc > 1 ? static_cast<std::size_t>(std::strtoull(argv[1], nullptr, 10)) : fallback;
+}
+
+#endif // BENCH_HPP
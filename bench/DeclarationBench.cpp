@@ -0,0 +1,39 @@
+// Declarations per second through the streaming scanner and the LL(1)
+// parser, on generated files of 10K declarations up to the given count.
+//
+// Usage: DeclarationBench [largest declaration count, default 10000000]
+
+#include <cstdio>
+#include <string>
+#include "Frontend/Parser.hpp"
+#include "Frontend/Scanner.hpp"
+#include "Bench.hpp"
+
+// Cycles through every declaration form the grammar has, about 14 bytes each
+std::string generateDeclarations(std::size_t count) {
+    const char* forms[] = {"int var;\n", "float x = 1;\n", "double y = z;\n", "char var;\n", "let x = 4;\n"};
+    std::string source;
+    source.reserve(count * 14);
+    for (std::size_t i = 0; i < count; i++) {
+        source += forms[i % 5];
+    }
+    return source;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t largest = countArgument(argc, argv, 10000000);
+    for (std::size_t count = 10000; count <= largest; count *= 10) {
+        std::string source = generateDeclarations(count);
+        bool parsed = false;
+        double seconds = bestSeconds(count < 1000000 ? 5 : 1, [&] {
+            Scanner scanner(source);
+            TokenStream tokens(scanner);
+            Parser parser(tokens, source);
+            parsed = parser.Parse();
+        });
+        std::printf("%9zu declarations  %6.1f MB  %8.2f ms  %6.2fM decl/s%s\n", count,
+                    static_cast<double>(source.size()) / (1024 * 1024), seconds * 1e3,
+                    static_cast<double>(count) / seconds / 1e6, parsed ? "" : "  (parse failed)");
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Edit-to-AST latency in the 401130253 final parser: a program of a million
+// lines is lexed and parsed once, then edited a line at a time as an editor
+// would, each edit brought into the tokens by LexicalAnalyzer::reanalyze and
+// into the tree by IncrementalParser. Reports the 50th and 99th percentile
+// of each step for edits that retype a number, which keeps a line's tokens,
+// and that change a line, insert one and delete one, against a full lex and
+// parse. The tree after the last edit must be the one a full parse builds.
+//
+// Usage: EditLatencyBench [lines, default 1000000]
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#define main finalParserMain
+#include "Frontend/401130253/کد نهایی با رفع ابهام و خطایابی.cpp"
+#undef main
+
+#include "Bench.hpp"
+
+namespace {
+
+const int EDITS_PER_KIND = 100;
+
+// One statement per line, of every shape, with enough different names and
+// numbers that few lines repeat
+string statement(mt19937 &random) {
+    static const char *const names[] = {"a", "b", "c", "sum", "i", "count", "x", "y"};
+    string name = names[random() % 8];
+    string other = names[random() % 8];
+    string number = to_string(random() % 100000);
+    switch (random() % 5) {
+        case 0: return "Put " + name + " = " + other + " + " + number + " - " + name + ";";
+        case 1: return "Read(" + name + ");";
+        case 2: return "Print(" + name + " - (" + other + " + " + number + "));";
+        case 3: return "If (" + name + " > " + number + ") { Put " + other + " = " + other + " + 1; }";
+        default: return "Iteration (" + name + " < " + number + ") { Print(" + other + "); }";
+    }
+}
+
+// `line` with its first number replaced by another
+string retyped(string line, mt19937 &random) {
+    size_t begin = line.find_first_of("0123456789");
+    if (begin == string::npos) return line;
+    size_t end = line.find_first_not_of("0123456789", begin);
+    return line.replace(begin, end - begin, to_string(random() % 100000));
+}
+
+// Where line `line` (from 1) starts in `code`
+size_t lineOffset(const string &code, int line) {
+    size_t at = 0;
+    for (int i = 1; i < line; i++) {
+        at = code.find('\n', at) + 1;
+    }
+    return at;
+}
+
+string render(const ASTArena &arena, NodeId node) {
+    string out(arena.value(node));
+    for (size_t i = 0; i < arena.childCount(node); i++) {
+        out += i == 0 ? '(' : ' ';
+        out += render(arena, arena.child(node, i));
+    }
+    return arena.childCount(node) > 0 ? out + ')' : out;
+}
+
+double percentile(vector<double> samples, size_t p) {
+    sort(samples.begin(), samples.end());
+    return samples[min(samples.size() - 1, p * samples.size() / 100)];
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    auto lineCount = static_cast<int>(countArgument(argc, argv, 1000000));
+    mt19937 random(25);
+    string code;
+    for (int i = 0; i < lineCount; i++) {
+        code += statement(random) + '\n';
+    }
+
+    LexicalAnalyzer lexer;
+    NodeId fullRoot = NO_NODE;
+    ASTArena fullArena;
+    double fullLex = measureSeconds([&] { lexer.analyze(code); });
+    double fullParse = measureSeconds([&] { fullRoot = Parser(lexer.getTokens(), fullArena).parse(); });
+    benchSink = benchSink + fullArena.size() + fullRoot;
+    IncrementalParser parser;
+    double firstParse = measureSeconds([&] { parser.parse(lexer.getTokens()); });
+    printf("%d lines, %.1f MB: full lex %.0f ms, full parse %.0f ms, first incremental parse %.0f ms\n", lineCount,
+           static_cast<double>(code.size()) / (1024 * 1024), fullLex * 1e3, fullParse * 1e3, firstParse * 1e3);
+
+    const char *const kinds[] = {"retype", "change", "insert", "delete"};
+    for (int kind = 0; kind < 4; kind++) {
+        vector<double> lexMs, parseMs, totalMs;
+        for (int edit = 0; edit < EDITS_PER_KIND; edit++) {
+            int line = 1 + static_cast<int>(random() % static_cast<unsigned>(lineCount));
+            size_t begin = lineOffset(code, line);
+            size_t end = code.find('\n', begin) + 1;
+            int oldLines = kind == 2 ? 0 : 1;
+            int newLines = kind == 3 ? 0 : 1;
+            string newLine = kind == 0 ? retyped(code.substr(begin, end - begin), random) : statement(random) + '\n';
+            code.replace(begin, kind == 2 ? 0 : end - begin, kind == 3 ? "" : newLine);
+            lineCount += newLines - oldLines;
+
+            double lexSeconds = measureSeconds([&] { lexer.reanalyze(code, line, oldLines, newLines); });
+            double parseSeconds = measureSeconds([&] { parser.parse(lexer.getTokens()); });
+            lexMs.push_back(lexSeconds * 1e3);
+            parseMs.push_back(parseSeconds * 1e3);
+            totalMs.push_back((lexSeconds + parseSeconds) * 1e3);
+        }
+        printf("%-6s  reanalyze p50 %6.2f p99 %6.2f ms  parse p50 %6.2f p99 %6.2f ms  edit-to-AST p50 %6.2f p99 %6.2f ms\n",
+               kinds[kind], percentile(lexMs, 50), percentile(lexMs, 99), percentile(parseMs, 50),
+               percentile(parseMs, 99), percentile(totalMs, 50), percentile(totalMs, 99));
+    }
+
+    LexicalAnalyzer fresh;
+    fresh.analyze(code);
+    ASTArena freshArena;
+    NodeId freshRoot = Parser(fresh.getTokens(), freshArena).parse();
+    NodeId root = parser.parse(lexer.getTokens());
+    bool same = render(parser.getArena(), root) == render(freshArena, freshRoot);
+    printf("arena %zu nodes, memo %zu statements; tree after the edits %s\n", parser.getArena().size(),
+           parser.getMemo().entries.size(), same ? "matches a full parse" : "DIFFERS from a full parse");
+    return same ? 0 : 1;
+}
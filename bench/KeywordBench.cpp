@@ -0,0 +1,49 @@
+// Keyword recognition: the compile-time perfect hash in Keywords::lookup
+// against the linear std::find over the keyword list it replaced.
+//
+// Usage: KeywordBench [lexemes]
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Frontend/Keywords.hpp"
+#include "Bench.hpp"
+
+int main(int argc, char* argv[]) {
+    std::size_t count = countArgument(argc, argv, 1000000);
+
+    // Keywords and identifiers in roughly the mix a scanner sees
+    const std::vector<std::string> words = {
+        "int", "x", "while", "foo", "return", "let", "counter", "string",
+        "i", "double", "zz", "else", "value", "if", "index", "float"
+    };
+    std::vector<std::string_view> lexemes;
+    lexemes.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        lexemes.push_back(words[(i * 7) % words.size()]);
+    }
+
+    const std::vector<std::string>& keywords = Keywords::getKeywords();
+    double linear = bestSeconds(5, [&] {
+        std::size_t found = 0;
+        for (std::string_view word : lexemes) {
+            found += std::find(keywords.begin(), keywords.end(), word) != keywords.end();
+        }
+        benchSink = benchSink + found;
+    });
+    double hashed = bestSeconds(5, [&] {
+        std::size_t found = 0;
+        for (std::string_view word : lexemes) {
+            found += Keywords::lookup(word) != Keyword::NONE;
+        }
+        benchSink = benchSink + found;
+    });
+
+    double lookups = static_cast<double>(count);
+    std::printf("%zu lookups\n", count);
+    std::printf("linear search   %6.2f ns/lookup\n", linear * 1e9 / lookups);
+    std::printf("perfect hash    %6.2f ns/lookup  (%.1fx)\n", hashed * 1e9 / lookups, linear / hashed);
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Lexemes per second in the 401130253 lexical analyzer: the single-pass
+// classifier it uses now against the per-lexeme std::regex checks it used
+// before, which are kept here as they were. The regex version is so much
+// slower that it only lexes the first sixteenth of the program; both report
+// a rate, and the tokens of that shared prefix must come out the same.
+//
+// Usage: LexemeBench [program bytes, default 4000000]
+
+#include <cstdio>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "Frontend/401130253/تحلیلگر لغوی.cpp"
+#include "Bench.hpp"
+
+struct RegexToken {
+    TokenKind kind;
+    string value;
+    int line;
+    int column;
+};
+
+class RegexLexicalAnalyzer {
+private:
+    vector<RegexToken> tokens;
+    string delimiters = " \t\n\r,;(){}=+-<>";
+
+    bool isIdentifier(const string &word) {
+        return regex_match(word, regex("^[a-zA-Z]{1,5}$"));
+    }
+
+    bool isInteger(const string &word) {
+        return regex_match(word, regex("^[0-9]+$"));
+    }
+
+    TokenKind getTokenKind(const string &word) {
+        if (word == "If") return TokenKind::IF;
+        if (word == "Iteration") return TokenKind::ITERATION;
+        if (word == "Put") return TokenKind::PUT;
+        if (word == "Read") return TokenKind::READ;
+        if (word == "Print") return TokenKind::PRINT;
+        if (word == "Var") return TokenKind::VAR;
+        if (word == "Program") return TokenKind::PROGRAM;
+        if (word == "Start") return TokenKind::START;
+        if (word == "End") return TokenKind::END;
+        if (isIdentifier(word)) return TokenKind::IDENTIFIER;
+        if (isInteger(word)) return TokenKind::INTEGER;
+        if (word == "==") return TokenKind::EQUAL;
+        return TokenKind::UNKNOWN;
+    }
+
+    TokenKind getSymbolKind(char c) {
+        switch (c) {
+            case ',': return TokenKind::COMMA;
+            case ';': return TokenKind::SEMICOLON;
+            case '(': return TokenKind::LEFT_PAREN;
+            case ')': return TokenKind::RIGHT_PAREN;
+            case '{': return TokenKind::LEFT_BRACE;
+            case '}': return TokenKind::RIGHT_BRACE;
+            case '=': return TokenKind::ASSIGN;
+            case '+': return TokenKind::PLUS;
+            case '-': return TokenKind::MINUS;
+            case '<': return TokenKind::LESS;
+            case '>': return TokenKind::GREATER;
+            default: return TokenKind::UNKNOWN;
+        }
+    }
+
+public:
+    void analyze(const string &code) {
+        tokens.clear();
+        string token;
+        int line = 1, column = 0;
+        for (size_t i = 0; i < code.size(); ++i) {
+            char c = code[i];
+            column++;
+            if (delimiters.find(c) != string::npos) {
+                if (!token.empty()) {
+                    tokens.push_back({getTokenKind(token), token, line, column - static_cast<int>(token.size())});
+                    token.clear();
+                }
+                if (c == '=' && i + 1 < code.size() && code[i + 1] == '=') {
+                    tokens.push_back({TokenKind::EQUAL, "==", line, column});
+                    ++i;
+                    column++;
+                } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                    tokens.push_back({getSymbolKind(c), string(1, c), line, column});
+                }
+                if (c == '\n') {
+                    line++;
+                    column = 0;
+                }
+            } else {
+                token += c;
+            }
+        }
+        if (!token.empty()) {
+            tokens.push_back({getTokenKind(token), token, line, column - static_cast<int>(token.size())});
+        }
+    }
+
+    const vector<RegexToken> &getTokens() const {
+        return tokens;
+    }
+};
+
+// Statements cycling through every kind of lexeme, ending on a line boundary
+string generateProgram(size_t bytes) {
+    const char *lines[] = {
+        "Var count;\n", "Put count = count + 12 - total;\n", "If (count == 100) { Print(count); }\n",
+        "Iteration (i < 3) { Read(i); }\n", "Put x = (a + b) - 7;\n", "Print(value > 0);\n"
+    };
+    string program = "Program\n";
+    for (size_t i = 0; program.size() < bytes; i++) {
+        program += lines[i % 6];
+    }
+    return program + "End\n";
+}
+
+int main(int argc, char* argv[]) {
+    string program = generateProgram(countArgument(argc, argv, 4000000));
+    string prefix = program.substr(0, program.rfind('\n', program.size() / 16) + 1);
+
+    LexicalAnalyzer lexer;
+    double seconds = bestSeconds(5, [&] { lexer.analyze(program); });
+    double lexemes = static_cast<double>(lexer.getTokens().size());
+
+    RegexLexicalAnalyzer regexLexer;
+    double regexSeconds = measureSeconds([&] { regexLexer.analyze(prefix); });
+    double regexLexemes = static_cast<double>(regexLexer.getTokens().size());
+
+    lexer.analyze(prefix);
+    const vector<Token> &tokens = lexer.getTokens();
+    const vector<RegexToken> &expected = regexLexer.getTokens();
+    bool same = tokens.size() == expected.size();
+    for (size_t i = 0; same && i < tokens.size(); i++) {
+        same = tokens[i].kind == expected[i].kind && tokens[i].value == expected[i].value &&
+               tokens[i].line == expected[i].line && tokens[i].column == expected[i].column;
+    }
+
+    std::printf("single pass  %6.2f MB  %9.0f lexemes  %8.3f s  %7.2fM lexemes/s\n",
+                static_cast<double>(program.size()) / (1024 * 1024), lexemes, seconds, lexemes / seconds / 1e6);
+    std::printf("regex        %6.2f MB  %9.0f lexemes  %8.3f s  %7.2fM lexemes/s\n",
+                static_cast<double>(prefix.size()) / (1024 * 1024), regexLexemes, regexSeconds,
+                regexLexemes / regexSeconds / 1e6);
+    std::printf("speedup %.0fx, tokens %s\n", (lexemes / seconds) / (regexLexemes / regexSeconds),
+                same ? "identical" : "DIFFER");
+    return same ? 0 : 1;
+}
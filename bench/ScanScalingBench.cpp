@@ -0,0 +1,44 @@
+// Parallel scan scaling: one source lexed by a sequential Scanner, then by
+// ParallelScanner on 1, 2, ... threads, as --jobs=N does for a single file.
+// Reports MB/s and the speedup over the sequential scan at each thread count.
+//
+// Usage: ScanScalingBench [lines, default 2000000] [most threads, default every core]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Frontend/ParallelScanner.hpp"
+#include "Bench.hpp"
+
+int main(int argc, char* argv[]) {
+    std::size_t lineCount = countArgument(argc, argv, 2000000);
+    unsigned mostThreads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10))
+                                    : std::thread::hardware_concurrency();
+    mostThreads = std::max(1u, mostThreads);
+
+    const char* const lines[] = {"int alpha = beta + 12;", "float x = 3.25 * y;", "while (a <= b) { a = a - 1; }",
+                                 "return foo(bar, baz);", ""};
+    std::string source;
+    for (std::size_t i = 0; i < lineCount; i++) {
+        source += lines[(i * 7) % std::size(lines)];
+        source += '\n';
+    }
+    double megabytes = static_cast<double>(source.size()) / (1024 * 1024);
+
+    double sequential = bestSeconds(3, [&] {
+        int lineNumber = 1;
+        benchSink = benchSink + Scanner().scan(source, lineNumber).size();
+    });
+    std::printf("%zu lines, %.1f MB, %u core(s)\n", lineCount, megabytes, std::thread::hardware_concurrency());
+    std::printf("sequential  %8.1f MB/s\n", megabytes / sequential);
+    for (unsigned threads = 1; threads <= mostThreads; threads++) {
+        ParallelScanner scanner(threads);
+        double seconds = bestSeconds(3, [&] { benchSink = benchSink + scanner.scan(source).size(); });
+        std::printf("%2u thread%s  %8.1f MB/s  (%.2fx)\n", threads, threads == 1 ? " " : "s", megabytes / seconds,
+                    sequential / seconds);
+    }
+    return 0;
+}
@@ -1,51 +1,235 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
-#include <fstream>
+#include "Frontend/BatchCompiler.hpp"
+#include "Frontend/CompileServer.hpp"
 #include "Frontend/Scanner.hpp"
+#include "Frontend/ParallelScanner.hpp"
+#include "Frontend/AstCache.hpp"
 #include "Frontend/Parser.hpp"
+#include "Frontend/TokenCache.hpp"
 
-std::vector<Token> scanFile(const std::string& filename) {
+std::vector<Token> scanFile(const SourceBuffer& source, unsigned jobs) {
     std::vector<Token> parsedTokens;
-    Scanner scanner;
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open the file " << filename << std::endl;
-        return parsedTokens;
+    if (jobs > 1) {
+        parsedTokens = ParallelScanner(jobs).scan(source);
+    } else {
+        parsedTokens = Scanner().scan(source);
     }
+    return parsedTokens;
+}
 
-    std::string line;
-    int lineNumber = 1;
-    while (std::getline(file, line)) {
-        std::vector<Token> tokens = scanner.scan(line, lineNumber);
-        for (const Token& token : tokens) {
-            parsedTokens.push_back(token);
+void printTokens(const std::vector<Token>& parsedTokens, const SourceBuffer& source) {
+    // Example: Displaying all parsed tokens after file scanning
+    std::cout << "\nAll parsed tokens:\n";
+    for (const Token& token : parsedTokens) {
+        std::cout << "Token: " << token.text(source.view()) << ", Type: " << token.getTypeAsString() << ", Line: " << token.line << '\n';
+    }
+}
+
+// One line per node in post-order, indented by depth. Depths are found by one
+// walk from the root back to the front, handing each node's depth to its children.
+void printAst(AstView ast, const std::vector<Token>& parsedTokens, const SourceBuffer& source) {
+    std::cout << "\nSyntax tree (post-order):\n";
+    std::vector<std::uint32_t> depth(ast.size(), 0);
+    for (std::size_t index = ast.size(); index-- > 0;) {
+        AstIndex child = AstView::lastChild(static_cast<AstIndex>(index));
+        for (std::uint32_t i = 0; i < ast[index].childCount; i++, child = ast.previousSibling(child)) {
+            depth[child] = depth[index] + 1;
         }
-        lineNumber++;
     }
+    for (AstIndex index = 0; index < ast.size(); index++) {
+        const AstNode& node = ast[index];
+        std::cout << std::string(2 * depth[index], ' ') << getAstKindName(node.kind);
+        if (node.token < parsedTokens.size()) {
+            const Token& token = parsedTokens[node.token];
+            std::cout << " " << token.text(source.view()) << " (line " << token.line << ")";
+        }
+        std::cout << '\n';
+    }
+}
 
-    file.close();
+enum class TokenListing { NONE, TEXT, BINARY };
 
-    // Example: Displaying all parsed tokens after file scanning
-    std::cout << "\nAll parsed tokens:\n";
-    for (const Token& token : parsedTokens) {
-        std::cout << "Token: " << token.value << ", Type: " << token.getTypeAsString() << ", Line: " << token.line << std::endl;
+// Compiles every file on `threadCount` threads, then reports diagnostics in
+// input order and a throughput summary.
+int compileBatch(const std::vector<std::string>& paths, unsigned threadCount, const CompileOptions& options) {
+    BatchCompiler compiler(threadCount, options);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<CompileResult> results = compiler.compile(paths);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::size_t bytes = 0, errors = 0, failedFiles = 0, unopened = 0, cached = 0;
+    for (std::size_t i = 0; i < paths.size(); i++) {
+        const CompileResult& result = results[i];
+        if (!result.opened) {
+            std::cerr << "Error: " << result.error << '\n';
+            unopened++;
+            continue;
+        }
+        bytes += result.bytes;
+        cached += result.cached;
+        if (!result.diagnostics.empty()) {
+            result.diagnostics.print(std::cerr, paths[i]);
+            errors += result.diagnostics.size();
+            failedFiles++;
+        }
     }
-    return parsedTokens;
 
+    double megabytes = static_cast<double>(bytes) / (1024 * 1024);
+    char summary[160];
+    std::snprintf(summary, sizeof(summary), "Compiled %zu file(s), %.2f MB in %.3f s on %u thread(s): %.0f files/s, %.1f MB/s",
+                  paths.size() - unopened, megabytes, seconds, compiler.getThreadCount(),
+                  seconds > 0 ? static_cast<double>(paths.size() - unopened) / seconds : 0.0,
+                  seconds > 0 ? megabytes / seconds : 0.0);
+    std::cout << summary << '\n';
+    if (cached > 0) {
+        std::cout << cached << " file(s) came from the AST cache" << '\n';
+    }
+    std::cout << errors << " error(s) in " << failedFiles << " file(s)" << std::endl;
+    return unopened > 0 ? 1 : 0;
 }
+
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <input_file>" << std::endl;
+    TokenListing emitTokens = TokenListing::NONE;
+    bool emitAst = false;
+    unsigned jobs = 1;
+    bool jobsGiven = false;
+    std::string astCacheDirectory;
+    std::string serveSocket;
+    std::string connectSocket;
+    bool shutdownServer = false;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--emit-tokens") {
+            emitTokens = TokenListing::TEXT;
+        } else if (arg == "--emit-tokens=bin") {
+            emitTokens = TokenListing::BINARY;
+        } else if (arg == "--emit-ast") {
+            emitAst = true;
+        } else if (arg.rfind("--ast-cache=", 0) == 0) {
+            astCacheDirectory = arg.substr(12);
+        } else if (arg.rfind("--serve=", 0) == 0) {
+            serveSocket = arg.substr(8);
+        } else if (arg.rfind("--connect=", 0) == 0) {
+            connectSocket = arg.substr(10);
+        } else if (arg == "--shutdown") {
+            shutdownServer = true;
+        } else if (arg.rfind("--jobs=", 0) == 0) {
+            jobs = static_cast<unsigned>(std::strtoul(arg.c_str() + 7, nullptr, 10));
+            if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+            jobsGiven = true;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+#ifndef _WIN32
+    // A server compiles whatever its clients send; a client hands its inputs to one
+    if (!serveSocket.empty()) {
+        CompileServer server(serveSocket, {astCacheDirectory},
+                             jobsGiven ? jobs : std::thread::hardware_concurrency());
+        return server.run(std::cout) ? 0 : 1;
+    }
+    if (!connectSocket.empty()) {
+        return runCompileClient(connectSocket, expandInputs(inputs), shutdownServer);
+    }
+#endif
+    if (inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--emit-tokens[=bin]] [--emit-ast] [--ast-cache=DIR] [--jobs=N] <input_file|->\n"
+                  << "       " << argv[0] << " [--ast-cache=DIR] [--jobs=N] <input_file|directory|@list>...\n"
+                  << "       " << argv[0] << " --serve=SOCKET [--ast-cache=DIR] [--jobs=N]\n"
+                  << "       " << argv[0] << " --connect=SOCKET [--shutdown] [<input_file|directory|@list>...]" << std::endl;
         return 1;
     }
 
-    std::string filePath = argv[1];
-    std::vector<Token> Tokens = scanFile(filePath);
-    Parser parser(Tokens);
+    // Several files, a directory or a list of files are compiled as a batch,
+    // on every core unless --jobs says otherwise
+    std::vector<std::string> paths = expandInputs(inputs);
+    if (paths.size() != 1 || paths[0] != inputs[0]) {
+        if (emitTokens != TokenListing::NONE || emitAst) {
+            std::cerr << "Error: --emit-tokens and --emit-ast take a single input file" << std::endl;
+            return 1;
+        }
+        return compileBatch(paths, jobsGiven ? jobs : std::thread::hardware_concurrency(), {astCacheDirectory});
+    }
+    const std::string& filePath = paths[0];
+
+    SourceBuffer source;
+    if (!source.open(filePath)) {
+        std::cerr << "Error: " << source.getError() << std::endl;
+        return 1;
+    }
+
+    // A source whose tree is already in the AST cache skips the front end
+    CachedAst cachedAst;
+    if (!astCacheDirectory.empty() && emitTokens == TokenListing::NONE &&
+        cachedAst.open(astCacheDirectory, source.view())) {
+        std::cout << "Parsing completed successfully" << std::endl;
+        if (emitAst) {
+            CachedTokenSource cachedTokens;
+            cachedAst.replayTokens(cachedTokens);
+            std::vector<Token> Tokens;
+            Tokens.reserve(cachedAst.tokenSize());
+            for (Token token; cachedTokens.nextToken(token);) {
+                Tokens.push_back(token);
+            }
+            printAst(cachedAst.view(), Tokens, source);
+        }
+        return 0;
+    }
+
+    // Tokens normally stream from the scanner straight into the parser, or
+    // from the file's token cache when one was written for a source of the
+    // same size and hash. The listings, the AST cache and the parallel scanner need them
+    // all up front, so only then are they materialized.
+    std::vector<Token> Tokens;
+    Scanner scanner(source.view());
+    VectorTokenSource scannedTokens(Tokens);
+    CachedTokenSource cachedTokens;
+    TokenSource* tokenSource = &scanner;
+    if (emitTokens == TokenListing::NONE && filePath != "-" &&
+        cachedTokens.open(tokenCachePath(filePath), source.view())) {
+        tokenSource = &cachedTokens;
+        if (emitAst || !astCacheDirectory.empty()) {
+            Tokens.reserve(cachedTokens.size());
+            for (Token token; cachedTokens.nextToken(token);) {
+                Tokens.push_back(token);
+            }
+            tokenSource = &scannedTokens;
+        }
+    } else if (emitTokens != TokenListing::NONE || emitAst || !astCacheDirectory.empty() || jobs > 1) {
+        Tokens = scanFile(source, jobs);
+        tokenSource = &scannedTokens;
+    }
+    if (emitTokens == TokenListing::TEXT) {
+        printTokens(Tokens, source);
+    } else if (emitTokens == TokenListing::BINARY) {
+        if (filePath == "-") {
+            std::cerr << "Error: --emit-tokens=bin needs an input file, not standard input" << std::endl;
+            return 1;
+        }
+        if (!writeTokenCache(tokenCachePath(filePath), Tokens, source.view())) {
+            std::cerr << "Error: Could not write " << tokenCachePath(filePath) << std::endl;
+            return 1;
+        }
+    }
+
+    TokenStream tokenStream(*tokenSource);
+    Parser parser(tokenStream, source.view());
 
     if(parser.Parse()) {
         std::cout << "Parsing completed successfully" << std::endl;
+        if (!astCacheDirectory.empty() && !writeAstCache(astCacheDirectory, source.view(), parser.getAst().view(), Tokens)) {
+            std::cerr << "Warning: Could not write to the AST cache in " << astCacheDirectory << std::endl;
+        }
     }else {
-        std::cout << "Parsing failed" << std::endl;
+        parser.getDiagnostics().print(std::cerr);
+        std::cout << "Parsing failed with " << parser.getDiagnostics().size() << " error(s)" << std::endl;
+    }
+    if (emitAst) {
+        printAst(parser.getAst().view(), Tokens, source);
     }
     return 0;
-}
\ No newline at end of file
+}
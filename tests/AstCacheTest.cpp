@@ -0,0 +1,120 @@
+// Writes an AST cache entry, reads it back, then damages its body in many
+// ways. CachedAst::open must either refuse the entry or hand out a tree
+// that can be walked, as printAst does, without leaving the node array.
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include "Frontend/AstCache.hpp"
+#include "Frontend/Parser.hpp"
+#include "Frontend/Scanner.hpp"
+#include "Check.hpp"
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// The same walk as printAst, checking every index it computes
+void walk(AstView ast, std::size_t tokenCount) {
+    std::vector<std::uint32_t> depth(ast.size(), 0);
+    for (std::size_t index = ast.size(); index-- > 0;) {
+        AstIndex child = AstView::lastChild(static_cast<AstIndex>(index));
+        for (std::uint32_t i = 0; i < ast[index].childCount; i++, child = ast.previousSibling(child)) {
+            check(child < index, "child " + std::to_string(child) + " of node " + std::to_string(index) + " is not before it");
+            depth[child] = depth[index] + 1;
+        }
+        check(ast[index].token <= tokenCount, "node " + std::to_string(index) + " refers past the tokens");
+    }
+}
+
+// Overwrites the entry with `bytes` at `offset` and reports whether open() still accepts it
+bool opensAfter(const std::string& path, const std::string& original, std::size_t offset, const std::string& bytes,
+                const std::string& directory, std::string_view source, std::size_t tokenCount) {
+    std::string damaged = original;
+    damaged.replace(offset, bytes.size(), bytes);
+    writeFile(path, damaged);
+    CachedAst cached;
+    if (!cached.open(directory, source)) return false;
+    walk(cached.view(), tokenCount);
+    return true;
+}
+
+std::string le32(std::uint32_t value) {
+    return std::string(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}  // namespace
+
+int main() {
+    std::string source = "int a = 1;\nfloat b = -(a + 2) * 3;\nlet c = b;\ndouble d;\n";
+    std::vector<Token> tokens;
+    Scanner scanner(source);
+    for (Token token; scanner.nextToken(token);) {
+        tokens.push_back(token);
+    }
+    VectorTokenSource tokenSource(tokens);
+    TokenStream stream(tokenSource);
+    Parser parser(stream, source);
+    check(parser.Parse(), "the test source does not parse");
+    AstView ast = parser.getAst().view();
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                      ("hut-ast-cache-test-" + std::to_string(std::random_device{}()));
+    check(writeAstCache(directory.string(), source, ast, tokens), "could not write the cache entry");
+    std::string path = astCachePath(directory.string(), source);
+    std::string original = readFile(path);
+
+    {
+        CachedAst cached;
+        check(cached.open(directory.string(), source), "the intact entry was refused");
+        check(cached.view().size() == ast.size(), "the intact entry has a different node count");
+        for (AstIndex i = 0; i < ast.size(); i++) {
+            const AstNode& want = ast[i];
+            const AstNode& got = cached.view()[i];
+            check(want.kind == got.kind && want.token == got.token && want.childCount == got.childCount &&
+                  want.span == got.span, "node " + std::to_string(i) + " changed on the way through the cache");
+        }
+    }
+
+    const std::size_t nodesAt = sizeof(AstCacheHeader);
+    const std::size_t root = nodesAt + (ast.size() - 1) * sizeof(AstNode);
+    auto field = [&](std::size_t node, std::size_t offset) { return nodesAt + node * sizeof(AstNode) + offset; };
+    std::string_view view = source;
+    std::size_t tokenCount = tokens.size();
+
+    check(!opensAfter(path, original, field(0, offsetof(AstNode, token)), le32(0x7FFFFFFF), directory.string(), view, tokenCount),
+          "a node referring past the tokens was accepted");
+    check(!opensAfter(path, original, root + offsetof(AstNode, span), le32(static_cast<std::uint32_t>(ast.size() - 1)),
+                      directory.string(), view, tokenCount),
+          "a root that does not span the tree was accepted");
+    check(!opensAfter(path, original, root + offsetof(AstNode, childCount), le32(1000), directory.string(), view, tokenCount),
+          "a root with more children than nodes was accepted");
+    check(!opensAfter(path, original, field(1, offsetof(AstNode, span)), le32(50), directory.string(), view, tokenCount),
+          "a subtree reaching before the first node was accepted");
+
+    // Random damage anywhere in the nodes: refused, or still safe to walk
+    std::mt19937 random(21);
+    std::size_t refused = 0;
+    for (int round = 0; round < 3000; round++) {
+        std::string bytes(1 + random() % 4, '\0');
+        for (char& byte : bytes) byte = static_cast<char>(random());
+        std::size_t offset = nodesAt + random() % (ast.size() * sizeof(AstNode) - bytes.size() + 1);
+        refused += !opensAfter(path, original, offset, bytes, directory.string(), view, tokenCount);
+    }
+    std::cout << refused << " of 3000 damaged entries refused, the rest walk safely\n";
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Compiles a directory of sources as a batch on several threads, some of them
+// with syntax errors, and checks that the files are found in path order
+// whatever order the file system lists them in, that each result matches
+// compiling the file alone, and that a file with errors does not stop the
+// ones after it. Then runs `HUT_Compiler --jobs=4` over the same directory
+// and checks that it prints the diagnostics in input order.
+//
+// Usage: BatchCompilerTest <path to HUT_Compiler>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Frontend/BatchCompiler.hpp"
+#include "Check.hpp"
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// A source of `declarations` declarations, the last of which misses its
+// name when `broken`; the count makes every file a different size
+std::string makeSource(std::size_t declarations, bool broken) {
+    std::string source;
+    for (std::size_t i = 0; i < declarations; i++) {
+        source += "int v" + std::to_string(i) + " = " + std::to_string(i) + " * (v" + std::to_string(i) + " + 1);\n";
+    }
+    return broken ? source + "float = 1;\n" : source;
+}
+
+std::string printed(const CompileResult& result, const std::string& path) {
+    std::ostringstream out;
+    result.diagnostics.print(out, path);
+    return out.str();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    check(argc > 1, "usage: BatchCompilerTest <path to HUT_Compiler>");
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                      ("hut-batch-compiler-test-" + std::to_string(std::random_device{}()));
+
+    // Written in an order unrelated to the path order, across nested
+    // directories, next to files that are not sources
+    std::vector<std::string> expectedPaths;
+    std::size_t brokenFiles = 0;
+    for (std::size_t i = 0; i < 24; i++) {
+        std::size_t shuffled = (i * 7) % 24;
+        std::filesystem::path file = directory / ("d" + std::to_string(shuffled % 3)) /
+                                     ("f" + std::to_string(shuffled) + ".hol");
+        if (shuffled % 4 == 0) file = directory / ("d" + std::to_string(shuffled % 3)) / "deeper" / file.filename();
+        std::filesystem::create_directories(file.parent_path());
+        bool broken = shuffled % 5 == 2;
+        brokenFiles += broken;
+        writeFile(file.string(), makeSource(shuffled + 1, broken));
+        writeFile(file.string() + ".txt", "not a source");
+        expectedPaths.push_back(file.string());
+    }
+    std::sort(expectedPaths.begin(), expectedPaths.end());
+
+    std::vector<std::string> paths = expandInputs({directory.string()});
+    check(paths == expectedPaths, "the directory expanded to " + std::to_string(paths.size()) +
+          " paths, not the " + std::to_string(expectedPaths.size()) + " sources in path order");
+    check(expandInputs({directory.string()}) == paths, "expanding the directory again gave another order");
+
+    // A list keeps its own order, and a path that cannot be opened is kept
+    // in place rather than dropped
+    std::string listPath = (directory / "list.txt").string();
+    std::string missingPath = (directory / "missing.hol").string();
+    writeFile(listPath, paths[3] + "\n" + missingPath + "\r\n\n" + paths[1] + "\n");
+    std::vector<std::string> listed = expandInputs({"@" + listPath, paths[0]});
+    check(listed == std::vector<std::string>({paths[3], missingPath, paths[1], paths[0]}),
+          "the list expanded out of order");
+
+    std::vector<std::string> withMissing = paths;
+    withMissing.insert(withMissing.begin() + 5, missingPath);
+    std::vector<CompileResult> results = BatchCompiler(4).compile(withMissing);
+    check(results.size() == withMissing.size(), "the batch returned " + std::to_string(results.size()) + " results");
+    std::string expectedErrors;
+    std::size_t failed = 0;
+    for (std::size_t i = 0; i < withMissing.size(); i++) {
+        const std::string& path = withMissing[i];
+        CompileWorkspace workspace;
+        CompileResult alone = compileFile(path, {}, workspace);
+        check(results[i].opened == (path != missingPath), path + (results[i].opened ? " was opened" : " was not opened"));
+        check(results[i].bytes == alone.bytes, path + ": the batch result at its place is for another file");
+        check(printed(results[i], path) == printed(alone, path),
+              path + " reported\n" + printed(results[i], path) + "in the batch, but alone\n" + printed(alone, path));
+        if (path != missingPath) expectedErrors += printed(alone, path);
+        failed += !alone.diagnostics.empty();
+    }
+    check(failed == brokenFiles, std::to_string(failed) + " files failed, expected " + std::to_string(brokenFiles));
+
+    // The compiler prints every file's diagnostics, in input order, and goes
+    // on after a file with errors
+    std::string outPath = (directory / "out.txt").string();
+    std::string errPath = (directory / "err.txt").string();
+    std::string command = "\"" + std::string(argv[1]) + "\" --jobs=4 \"" + directory.string() + "\" > \"" + outPath +
+                          "\" 2> \"" + errPath + "\"";
+    check(std::system(command.c_str()) == 0, "\"" + command + "\" failed");
+    std::string errors = readFile(errPath);
+    check(errors == expectedErrors, "the compiler reported\n" + errors + "expected\n" + expectedErrors);
+    std::string output = readFile(outPath);
+    std::string summary = "Compiled " + std::to_string(paths.size()) + " file(s)";
+    check(output.rfind(summary, 0) == 0, "the compiler printed \"" + output + "\", not \"" + summary + "...\"");
+    std::string counts = std::to_string(brokenFiles) + " error(s) in " + std::to_string(brokenFiles) + " file(s)\n";
+    check(output.size() >= counts.size() && output.compare(output.size() - counts.size(), counts.size(), counts) == 0,
+          "the compiler printed \"" + output + "\", not \"..." + counts + "\"");
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
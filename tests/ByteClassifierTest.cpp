@@ -0,0 +1,101 @@
+// Runs ByteClassifier::skipRun at every SIMD level the CPU supports and
+// checks each against a byte-at-a-time walk with inRun, from every start
+// offset of random and edge-length inputs.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "Frontend/ByteClassifier.hpp"
+#include "Check.hpp"
+
+namespace {
+
+const char* referenceSkip(ByteRun run, const char* cursor, const char* end) {
+    while (cursor != end && ByteClassifier::inRun(run, *cursor)) {
+        ++cursor;
+    }
+    return cursor;
+}
+
+const char* levelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR: return "scalar";
+        case SimdLevel::SSE2: return "SSE2";
+        case SimdLevel::AVX2: return "AVX2";
+    }
+    return "?";
+}
+
+const char* runName(ByteRun run) {
+    switch (run) {
+        case ByteRun::BLANK: return "BLANK";
+        case ByteRun::LETTER: return "LETTER";
+        case ByteRun::DIGIT: return "DIGIT";
+        case ByteRun::WORD: return "WORD";
+    }
+    return "?";
+}
+
+// Mostly bytes inside the run being skipped, so runs are long enough to
+// cross vector boundaries, with one byte in `noise` drawn from anywhere.
+std::vector<char> randomInput(std::mt19937& random, ByteRun run, std::size_t length, unsigned noise = 24) {
+    std::vector<char> members;
+    for (int byte = 0; byte < 256; byte++) {
+        if (ByteClassifier::inRun(run, static_cast<char>(byte))) members.push_back(static_cast<char>(byte));
+    }
+    std::vector<char> input(length);
+    for (char& ch : input) {
+        ch = noise != 0 && random() % noise == 0 ? static_cast<char>(random() % 256) : members[random() % members.size()];
+    }
+    return input;
+}
+
+void checkFrom(SimdLevel level, ByteRun run, const std::vector<char>& input, std::size_t offset) {
+    const char* begin = input.data();
+    const char* end = begin + input.size();
+    const char* expected = referenceSkip(run, begin + offset, end);
+    const char* actual = ByteClassifier::skipRun(run, begin + offset, end);
+    check(expected == actual, std::string(levelName(level)) + " " + runName(run) + " run of a " +
+          std::to_string(input.size()) + "-byte input from offset " + std::to_string(offset) +
+          ": expected end " + std::to_string(expected - begin) + ", got " + std::to_string(actual - begin));
+}
+
+// The vector holds exactly the input, so a load past its end would read
+// outside the allocation
+void checkEveryOffset(SimdLevel level, ByteRun run, const std::vector<char>& input) {
+    for (std::size_t offset = 0; offset <= input.size(); offset++) {
+        checkFrom(level, run, input, offset);
+    }
+}
+
+}  // namespace
+
+int main() {
+    std::vector<SimdLevel> levels = {SimdLevel::SCALAR};
+    if (ByteClassifier::detect() != SimdLevel::SCALAR) levels.push_back(SimdLevel::SSE2);
+    if (ByteClassifier::detect() == SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+
+    std::mt19937 random(7);
+    for (SimdLevel level : levels) {
+        ByteClassifier::setLevel(level);
+        check(ByteClassifier::level() == level, std::string("could not select ") + levelName(level));
+        for (ByteRun run : {ByteRun::BLANK, ByteRun::LETTER, ByteRun::DIGIT, ByteRun::WORD}) {
+            // Every byte value, alone and ending a run at each position around a vector width
+            for (int byte = 0; byte < 256; byte++) {
+                for (std::size_t position : {0, 1, 15, 16, 17, 31, 32, 33, 63, 64}) {
+                    std::vector<char> input = randomInput(random, run, position + 1 + random() % 2, 0);
+                    input[position] = static_cast<char>(byte);
+                    checkFrom(level, run, input, 0);
+                }
+            }
+            for (std::size_t length = 0; length <= 130; length++) {
+                checkEveryOffset(level, run, randomInput(random, run, length));
+            }
+            for (int round = 0; round < 20; round++) {
+                checkEveryOffset(level, run, randomInput(random, run, 200 + random() % 2000));
+            }
+        }
+    }
+    std::cout << levels.size() << " SIMD level(s) agree with the scalar walk\n";
+    return 0;
+}
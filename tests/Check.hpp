@@ -0,0 +1,17 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Reports a failed expectation and ends the test with a non-zero status, so
+// ctest shows the first thing that went wrong instead of a cascade.
+inline void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << '\n';
+        std::exit(1);
+    }
+}
+
+#endif // CHECK_HPP
@@ -0,0 +1,123 @@
+// Runs a compile server with a single worker and talks to it over its
+// socket. A client that connects and sends nothing must not hold up anyone
+// else, requests sent back to back on one connection are answered in order,
+// SHUTDOWN is answered at once and cuts off the idle client, and the server
+// leaves the process-wide interner alone. Then a server with two workers is
+// jammed by a client that sends requests and never reads the replies; the
+// other client must still be answered at once.
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <random>
+#include <sstream>
+#include <string>
+#include "Frontend/CompileServer.hpp"
+#include "Check.hpp"
+
+namespace {
+
+int connectTo(const std::string& socketPath) {
+    sockaddr_un address{};
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    check(fd >= 0 && makeSocketAddress(socketPath, address), "could not make a client socket");
+    for (int attempt = 0; attempt < 500; attempt++) {
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            timeval timeout{10, 0};  // A reply that never comes fails the test instead of hanging it
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            return fd;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));  // The server may still be starting
+    }
+    check(false, "could not connect to " + socketPath);
+    return -1;
+}
+
+// Reads lines until a final "OK", "ERROR", "STATS" or "BYE" line, which is returned
+std::string readReply(LineChannel& channel) {
+    for (std::string line; channel.readLine(line);) {
+        if (line.rfind("OK ", 0) == 0 || line.rfind("ERROR ", 0) == 0 || line.rfind("STATS ", 0) == 0 ||
+            line == "BYE") {
+            return line;
+        }
+    }
+    return "";
+}
+
+}  // namespace
+
+int main() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                      ("hut-server-test-" + std::to_string(std::random_device{}()));
+    std::filesystem::create_directories(directory);
+    std::string good = (directory / "good.hol").string();
+    std::string bad = (directory / "bad.hol").string();
+    std::ofstream(good) << "int alpha = 1;\nfloat beta = -(alpha + 2) * 3;\n";
+    std::ofstream(bad) << "int gamma = ;\n";
+    std::string socketPath = (directory / "server.sock").string();
+
+    std::size_t globalSymbols = Interner::global().size();
+    std::ostringstream log;
+    CompileServer server(socketPath, {}, 1);
+    std::future<bool> served = std::async(std::launch::async, [&] { return server.run(log); });
+
+    LineChannel idle(connectTo(socketPath));
+    LineChannel busy(connectTo(socketPath));
+
+    // Three requests in one write, answered in the order they were sent
+    check(busy.write("COMPILE " + good + "\nCOMPILE " + bad + "\nCOMPILE " + directory.string() + "/missing.hol\n"),
+          "could not send the requests");
+    std::string first = readReply(busy);
+    std::string second = readReply(busy);
+    std::string third = readReply(busy);
+    check(first.rfind("OK 0 ", 0) == 0, "the good file was answered with \"" + first + "\"");
+    check(second.rfind("OK ", 0) == 0 && second.rfind("OK 0 ", 0) != 0, "the bad file was answered with \"" + second + "\"");
+    check(third.rfind("ERROR ", 0) == 0, "the missing file was answered with \"" + third + "\"");
+    check(busy.write("STATS\n") && readReply(busy).rfind("STATS 2 ", 0) == 0, "STATS does not count two compiles");
+
+    // A worker's names stay in its own interner
+    check(Interner::global().size() == globalSymbols, "the server interned into the global interner");
+
+    LineChannel stopper(connectTo(socketPath));
+    check(stopper.write("SHUTDOWN\n") && readReply(stopper) == "BYE", "SHUTDOWN was not answered");
+    check(served.wait_for(std::chrono::seconds(10)) == std::future_status::ready,
+          "the server did not stop while a client sat idle");
+    check(served.get(), "the server could not listen");
+
+    std::string line;
+    check(!idle.readLine(line), "the idle connection was left open");
+    check(!std::filesystem::exists(socketPath), "the socket file was left behind");
+
+    CompileServer twoWorkers(socketPath, {}, 2);
+    served = std::async(std::launch::async, [&] { return twoWorkers.run(log); });
+    {
+        // As many STATS as the socket takes, without waiting, so the replies
+        // back up until the worker writing them is stuck
+        LineChannel other(connectTo(socketPath));
+        int jammedFd = connectTo(socketPath);
+        std::string burst;
+        for (int i = 0; i < 10000; i++) burst += "STATS\n";
+        std::size_t sent = 0;
+        for (ssize_t n; (n = ::send(jammedFd, burst.data(), burst.size(), MSG_DONTWAIT)) > 0;) {
+            sent += static_cast<std::size_t>(n);
+        }
+        check(sent > 0, "could not send to the server");
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        auto start = std::chrono::steady_clock::now();
+        check(other.write("COMPILE " + good + "\n") && readReply(other).rfind("OK 0 ", 0) == 0,
+              "a client was not answered while another stopped reading");
+        check(other.write("STATS\n") && readReply(other).rfind("STATS ", 0) == 0,
+              "STATS was not answered while another client stopped reading");
+        check(std::chrono::steady_clock::now() - start < std::chrono::seconds(5),
+              "a client that stopped reading held up another one");
+        ::close(jammedFd);  // The stuck worker's write fails and it is free again
+        check(other.write("SHUTDOWN\n") && readReply(other) == "BYE", "SHUTDOWN was not answered");
+    }
+    check(served.wait_for(std::chrono::seconds(10)) == std::future_status::ready,
+          "the second server did not stop");
+    check(served.get(), "the second server could not listen");
+    std::filesystem::remove_all(directory);
+    return 0;
+}
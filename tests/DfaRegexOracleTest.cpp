@@ -0,0 +1,181 @@
+// Checks the table-driven DFA and the scanner against a reference scanner
+// built on the regular expressions the DFA used to evaluate per byte. The
+// reference is slow but obviously right: at each position it tries every
+// prefix against the patterns and keeps the longest one that matches.
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+#include "Frontend/Scanner.hpp"
+#include "Check.hpp"
+
+namespace {
+
+class RegexScanner {
+public:
+    RegexScanner()
+        : identifierRegex("^[a-zA-Z_][a-zA-Z0-9_]*$"),
+          numberRegex("^[0-9]+(\\.[0-9]+)?$"),
+          operatorRegex("^[+\\-*/=<>!&|^%]+$"),
+          delimiterRegex(R"([(){}[\];,])") {}
+
+    std::vector<Token> scan(const std::string& source) const {
+        std::vector<Token> tokens;
+        std::size_t lineStart = 0;
+        int line = 1;
+        for (std::size_t i = 0; i < source.size();) {
+            if (std::isspace(static_cast<unsigned char>(source[i]))) {
+                if (source[i] == '\n') {
+                    line++;
+                    lineStart = i + 1;
+                }
+                i++;
+                continue;
+            }
+
+            TokenType type = TokenType::UNKNOWN;
+            std::size_t length = 1;
+            if (std::regex_match(source.substr(i, 1), delimiterRegex)) {
+                type = TokenType::DELIMITER;
+            } else {
+                // No token runs past a byte that none of the patterns contain
+                std::size_t limit = i;
+                while (limit < source.size() && (std::isalnum(static_cast<unsigned char>(source[limit])) ||
+                                                 std::string_view("_.+-*/=<>!&|^%").find(source[limit]) != std::string_view::npos)) {
+                    limit++;
+                }
+                for (std::size_t candidate = 1; i + candidate <= limit; candidate++) {
+                    std::string lexeme = source.substr(i, candidate);
+                    if (std::regex_match(lexeme, identifierRegex)) {
+                        type = isOldKeyword(lexeme) ? TokenType::KEYWORD : TokenType::IDENTIFIER;
+                    } else if (std::regex_match(lexeme, numberRegex)) {
+                        type = TokenType::NUMBER;
+                    } else if (std::regex_match(lexeme, operatorRegex) && isOperator(lexeme)) {
+                        type = TokenType::OPERATOR;
+                    } else {
+                        continue;
+                    }
+                    length = candidate;
+                }
+            }
+            tokens.emplace_back(type, static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(length), line,
+                                static_cast<int>(i - lineStart) + 1);
+            i += length;
+        }
+        return tokens;
+    }
+
+private:
+    std::regex identifierRegex;
+    std::regex numberRegex;
+    std::regex operatorRegex;
+    std::regex delimiterRegex;
+
+    // Operator runs are split into the longest operators the language has
+    static bool isOperator(const std::string& lexeme) {
+        return std::find(OPERATORS.begin(), OPERATORS.end(), lexeme) != OPERATORS.end();
+    }
+
+    static bool isOldKeyword(const std::string& lexeme) {
+        const std::vector<std::string>& keywords = Keywords::getKeywords();
+        return std::find(keywords.begin(), keywords.end(), lexeme) != keywords.end();
+    }
+};
+
+std::string describe(const std::string& source, const Token& token) {
+    return "'" + std::string(token.text(source)) + "' " + token.getTypeAsString() + " at " +
+           std::to_string(token.line) + ":" + std::to_string(token.column);
+}
+
+void compare(const RegexScanner& reference, const std::string& source) {
+    std::vector<Token> expected = reference.scan(source);
+    Scanner scanner(source);
+    std::vector<Token> actual;
+    for (Token token; scanner.nextToken(token);) {
+        actual.push_back(token);
+    }
+
+    for (std::size_t i = 0; i < std::min(expected.size(), actual.size()); i++) {
+        const Token& want = expected[i];
+        const Token& got = actual[i];
+        check(want.type == got.type && want.offset == got.offset && want.length == got.length &&
+              want.line == got.line && want.column == got.column,
+              "token " + std::to_string(i) + " of \"" + source + "\": expected " + describe(source, want) +
+              ", scanned " + describe(source, got));
+    }
+    check(expected.size() == actual.size(),
+          "token count of \"" + source + "\": expected " + std::to_string(expected.size()) +
+          ", scanned " + std::to_string(actual.size()));
+}
+
+// Every byte from START, inside an identifier and inside a number, against
+// the character classes the regexes spell out.
+void checkTransitions() {
+    const std::regex identifierStart("[a-zA-Z_]");
+    const std::regex identifierPart("[a-zA-Z0-9_]");
+    const std::regex digit("[0-9]");
+    const std::regex operatorChar("[+\\-*/=<>!&|^%]");
+    const std::regex delimiter(R"([(){}[\];,])");
+    for (int byte = 0; byte < 256; byte++) {
+        std::string ch(1, static_cast<char>(byte));
+        DFA dfa;
+        State fromStart = dfa.transition(ch[0]);
+        State expected = std::regex_match(ch, operatorChar) ? State::IN_OPERATOR
+                         : std::regex_match(ch, digit) ? State::IN_NUMBER
+                         : std::regex_match(ch, identifierStart) ? State::IN_KEYWORD
+                         : std::regex_match(ch, delimiter) ? State::IN_DELIMITER
+                         : State::IN_UNKNOWN;
+        check(fromStart == expected, "START on byte " + std::to_string(byte));
+
+        dfa.reset();
+        dfa.transition('a');
+        State inWord = dfa.transition(ch[0]);
+        check((inWord == State::IN_KEYWORD) == std::regex_match(ch, identifierPart),
+              "IN_KEYWORD on byte " + std::to_string(byte));
+
+        dfa.reset();
+        dfa.transition('1');
+        State inNumber = dfa.transition(ch[0]);
+        check((inNumber == State::IN_NUMBER) == std::regex_match(ch, digit) &&
+              (inNumber == State::IN_NUMBER_DOT) == (byte == '.'),
+              "IN_NUMBER on byte " + std::to_string(byte));
+    }
+}
+
+std::string randomSource(std::mt19937& random, std::size_t pieces) {
+    static const std::vector<std::string> fragments = {
+        "a", "Zed", "_x1", "int", "float", "while", "do", "return", "letter", "if2",
+        "0", "42", "3.14", "7.", ".5", "1..2", "00",
+        "+", "-", "*", "/", "=", "<", ">", "!", "&", "|", "^", "%",
+        "==", "<<=", ">>=", "->", "=-", "+++", "!==", "&&&", "||=",
+        "(", ")", "{", "}", "[", "]", ";", ",",
+        " ", " ", "  ", "\t", "\n", "\r\n", "#", "@", "$", "\"", "\x80"
+    };
+    std::string source;
+    for (std::size_t i = 0; i < pieces; i++) {
+        source += fragments[random() % fragments.size()];
+    }
+    return source;
+}
+
+}  // namespace
+
+int main() {
+    checkTransitions();
+
+    RegexScanner reference;
+    for (const char* source : {"", " ", "x", "12.", "12.5.6", "a<<=b>>=c", "x=-1", "i+++j", "if(x){return 0;}",
+                               "\n\n  int y = 3.25;\n", "a.b", "&&|||", "1e5", "ends without newline"}) {
+        compare(reference, source);
+    }
+
+    std::mt19937 random(2024);
+    for (int round = 0; round < 400; round++) {
+        compare(reference, randomSource(random, 1 + random() % 60));
+    }
+    std::cout << "DFA and scanner agree with the regex patterns\n";
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Parses expressions on their own with ExpressionParser and checks the tree
+// its postfix output describes, written as "(op operand ...)": precedence,
+// left associativity, prefix operators and parentheses. Also checks where
+// it leaves the token stream, and that a stray or trailing operator, an
+// empty or unclosed parenthesis and a missing operand are errors.
+
+#include <string>
+#include <vector>
+#include "Frontend/ExpressionParser.hpp"
+#include "Frontend/Scanner.hpp"
+#include "Check.hpp"
+
+namespace {
+
+struct Parsed {
+    bool ok;
+    std::string tree;     // Or the diagnostic, when not ok
+    std::string stopped;  // The token the stream was left on, or "" at the end
+};
+
+Parsed parse(std::string_view source) {
+    Scanner scanner(source);
+    TokenStream stream(scanner);
+    Diagnostics diagnostics;
+    ExpressionParser parser(stream, source, diagnostics);
+    std::vector<ExpressionItem> postfix;
+    Parsed parsed{parser.parse(postfix), "", std::string(stream.peek().text(source))};
+    if (!parsed.ok) {
+        const Diagnostic& error = diagnostics.all().front();
+        parsed.tree = error.message + " at column " + std::to_string(error.column);
+        return parsed;
+    }
+
+    // Rebuild the tree from the postfix form with a stack of subtrees
+    std::vector<std::string> operands;
+    for (const ExpressionItem& item : postfix) {
+        std::string node(item.token.text(source));
+        if (item.arity > 0) {
+            std::string args;
+            for (std::size_t i = operands.size() - item.arity; i < operands.size(); i++) {
+                args += " " + operands[i];
+            }
+            operands.resize(operands.size() - item.arity);
+            node = "(" + node + args + ")";
+        }
+        operands.push_back(node);
+    }
+    check(operands.size() == 1, "\"" + std::string(source) + "\" left " + std::to_string(operands.size()) +
+          " subtrees instead of one");
+    parsed.tree = operands.front();
+    return parsed;
+}
+
+void checkTree(std::string_view source, const std::string& expectedTree, const std::string& expectedStop = "") {
+    Parsed parsed = parse(source);
+    std::string what = "\"" + std::string(source) + "\"";
+    check(parsed.ok, what + " was rejected: " + parsed.tree);
+    check(parsed.tree == expectedTree, what + " parsed to " + parsed.tree + ", expected " + expectedTree);
+    check(parsed.stopped == expectedStop, what + " stopped at \"" + parsed.stopped + "\", expected \"" +
+          expectedStop + "\"");
+}
+
+void checkError(std::string_view source, const std::string& expectedError) {
+    Parsed parsed = parse(source);
+    std::string what = "\"" + std::string(source) + "\"";
+    check(!parsed.ok, what + " was accepted as " + parsed.tree);
+    check(parsed.tree == expectedError, what + " gave \"" + parsed.tree + "\", expected \"" + expectedError + "\"");
+}
+
+}  // namespace
+
+int main() {
+    // Operands
+    checkTree("a", "a");
+    checkTree("42", "42");
+
+    // Left associativity at every level
+    checkTree("a - b - c", "(- (- a b) c)");
+    checkTree("a / b * c % d", "(% (* (/ a b) c) d)");
+    checkTree("a < b >= c", "(>= (< a b) c)");
+    checkTree("a || b || c", "(|| (|| a b) c)");
+
+    // Tighter operators nest under looser ones on either side
+    checkTree("a + b * c", "(+ a (* b c))");
+    checkTree("a * b + c", "(+ (* a b) c)");
+    checkTree("a << b + c", "(<< a (+ b c))");
+    checkTree("a == b < c", "(== a (< b c))");
+    checkTree("a | b ^ c & d", "(| a (^ b (& c d)))");
+    checkTree("a || b && c == d + e * f", "(|| a (&& b (== c (+ d (* e f)))))");
+    checkTree("a * b - c / d", "(- (* a b) (/ c d))");
+
+    // Prefix operators bind tighter than any binary one and stack
+    checkTree("-a", "(- a)");
+    checkTree("+a * b", "(* (+ a) b)");
+    checkTree("!a && b", "(&& (! a) b)");
+    checkTree("- -a", "(- (- a))");
+    checkTree("a - -b", "(- a (- b))");
+    checkTree("!-+a", "(! (- (+ a)))");
+
+    // Parentheses override precedence and may nest
+    checkTree("(a + b) * c", "(* (+ a b) c)");
+    checkTree("a - (b - c)", "(- a (- b c))");
+    checkTree("((a))", "a");
+    checkTree("-(a + (b * (c - d)))", "(- (+ a (* b (- c d))))");
+    checkTree("((a + b) * (c + d)) / e", "(/ (* (+ a b) (+ c d)) e)");
+
+    // The expression ends at the first token that cannot continue it
+    checkTree("a + b; c", "(+ a b)", ";");
+    checkTree("a = b", "a", "=");
+    checkTree("a b", "a", "b");
+    checkTree("(a))", "a", ")");
+
+    // Stray, trailing and doubled operators and unbalanced parentheses
+    checkError("", "Expected Identifier, Number or ( but got end of input at column 1");
+    checkError("* a", "Expected Identifier, Number or ( but got * at column 1");
+    checkError("a +", "Expected Identifier, Number or ( but got end of input at column 4");
+    checkError("a + ;", "Expected Identifier, Number or ( but got ; at column 5");
+    checkError("a * / b", "Expected Identifier, Number or ( but got / at column 5");
+    checkError("-", "Expected Identifier, Number or ( but got end of input at column 2");
+    checkError("()", "Expected Identifier, Number or ( but got ) at column 2");
+    checkError("(a + b", "Expected ) but got end of input at column 7");
+    checkError("((a) * b;", "Expected ) but got ; at column 9");
+    return 0;
+}
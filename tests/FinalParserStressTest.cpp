@@ -0,0 +1,115 @@
+// Parses ten million statements, and a long +/- chain, with the final
+// parser on a 256 KiB stack. Statement lists and expressions are loops over
+// explicit stacks, so the native stack must not grow with program length.
+// Tokens are built in memory rather than lexed, which keeps the run to the
+// parser and its arena; statements per second are reported.
+//
+// Usage: FinalParserStressTest [statements, default 10000000]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#define main finalParserMain
+#include "Frontend/401130253/کد نهایی با رفع ابهام و خطایابی.cpp"
+#undef main
+
+#include "Check.hpp"
+
+namespace {
+
+const size_t STACK_BYTES = 256 * 1024;
+
+// Runs `work` on a thread whose whole stack is STACK_BYTES, so recursion
+// that grows with the input overflows it and crashes the test.
+void runOnSmallStack(const function<void()> &work) {
+#ifndef _WIN32
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    check(pthread_attr_setstacksize(&attributes, STACK_BYTES) == 0, "could not size the parser thread's stack");
+    pthread_t thread;
+    auto run = [](void *argument) -> void * {
+        (*static_cast<const function<void()> *>(argument))();
+        return nullptr;
+    };
+    check(pthread_create(&thread, &attributes, run, const_cast<function<void()> *>(&work)) == 0,
+          "could not start the parser thread");
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attributes);
+#else
+    work();  // No portable way to size the stack; the default one still bounds it
+#endif
+}
+
+Token makeToken(TokenKind kind, const string &value, int line, int column) {
+    return {kind, value, line, column, kind == TokenKind::IDENTIFIER ? packName(value) : NO_NAME};
+}
+
+void parseStatements(size_t count) {
+    // "Read(a);" is the statement with the fewest tokens and nodes, which
+    // keeps ten million of them within a few GB
+    vector<Token> tokens;
+    tokens.reserve(count * 5);
+    for (size_t i = 0; i < count; i++) {
+        int line = static_cast<int>(i + 1);
+        tokens.push_back(makeToken(TokenKind::READ, "Read", line, 1));
+        tokens.push_back(makeToken(TokenKind::LEFT_PAREN, "(", line, 5));
+        tokens.push_back(makeToken(TokenKind::IDENTIFIER, "a", line, 6));
+        tokens.push_back(makeToken(TokenKind::RIGHT_PAREN, ")", line, 7));
+        tokens.push_back(makeToken(TokenKind::SEMICOLON, ";", line, 8));
+    }
+
+    ASTArena arena;
+    NodeId root = NO_NODE;
+    size_t errors = 0;
+    double seconds = 0;
+    runOnSmallStack([&] {
+        auto start = chrono::steady_clock::now();
+        Parser parser(tokens, arena);
+        root = parser.parse();
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        errors = parser.getDiagnostics().size();
+    });
+    check(errors == 0, to_string(errors) + " error(s) parsing " + to_string(count) + " statements");
+    check(arena.childCount(root) == count, "States has " + to_string(arena.childCount(root)) + " children, expected " + to_string(count));
+    printf("%zu statements in %.2f s: %.2fM statements/s, %zu nodes\n", count, seconds,
+           static_cast<double>(count) / seconds / 1e6, arena.size());
+}
+
+void parseChain(size_t terms) {
+    vector<Token> tokens = {makeToken(TokenKind::PRINT, "Print", 1, 1), makeToken(TokenKind::LEFT_PAREN, "(", 1, 6)};
+    tokens.reserve(2 * terms + 4);
+    for (size_t i = 0; i < terms; i++) {
+        if (i > 0) tokens.push_back(makeToken(i % 2 ? TokenKind::PLUS : TokenKind::MINUS, i % 2 ? "+" : "-", 1, 7));
+        tokens.push_back(i % 3 ? makeToken(TokenKind::IDENTIFIER, "a", 1, 7) : makeToken(TokenKind::INTEGER, "1", 1, 7));
+    }
+    tokens.push_back(makeToken(TokenKind::RIGHT_PAREN, ")", 1, 8));
+    tokens.push_back(makeToken(TokenKind::SEMICOLON, ";", 1, 9));
+
+    ASTArena arena;
+    size_t errors = 0;
+    double seconds = 0;
+    runOnSmallStack([&] {
+        auto start = chrono::steady_clock::now();
+        Parser parser(tokens, arena);
+        parser.parse();
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        errors = parser.getDiagnostics().size();
+    });
+    check(errors == 0, to_string(errors) + " error(s) parsing a " + to_string(terms) + "-term chain");
+    printf("%zu-term +/- chain in %.2f s, %zu nodes\n", terms, seconds, arena.size());
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+    parseStatements(count);
+    parseChain(count / 10);
+    return 0;
+}
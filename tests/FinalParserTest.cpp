@@ -0,0 +1,82 @@
+// Trees the final parser builds for small programs, including ones with
+// syntax errors, written out as nested values.
+
+#include <string>
+
+#define main finalParserMain
+#include "Frontend/401130253/کد نهایی با رفع ابهام و خطایابی.cpp"
+#undef main
+
+#include "Check.hpp"
+
+namespace {
+
+// "value(child child ...)", or just "value" for a leaf
+string render(const ASTArena &arena, NodeId node) {
+    string out(arena.value(node));
+    if (arena.childCount(node) > 0) {
+        out += '(';
+        for (size_t i = 0; i < arena.childCount(node); i++) {
+            if (i > 0) out += ' ';
+            out += render(arena, arena.child(node, i));
+        }
+        out += ')';
+    }
+    return out;
+}
+
+void checkTree(const string &code, const string &expectedTree, size_t expectedErrors) {
+    LexicalAnalyzer lexer;
+    lexer.analyze(code);
+    ASTArena arena;
+    Parser parser(lexer.getTokens(), arena);
+    string tree = render(arena, parser.parse());
+    check(tree == expectedTree, "\"" + code + "\" parsed to " + tree + ", expected " + expectedTree);
+    check(parser.getDiagnostics().size() == expectedErrors,
+          "\"" + code + "\" gave " + to_string(parser.getDiagnostics().size()) + " error(s), expected " +
+          to_string(expectedErrors));
+}
+
+// Saves a tree twice, so the second save replaces an existing entry, loads
+// it back, and then checks that a damaged entry is refused.
+void checkCache() {
+    string code = "Put a = 1 - (b + c);\nIf (a > 2) { Print(a); }\n";
+    LexicalAnalyzer lexer;
+    lexer.analyze(code);
+    ASTArena arena;
+    Parser parser(lexer.getTokens(), arena);
+    NodeId root = parser.parse();
+    check(saveCachedAST(code, arena, root) && saveCachedAST(code, arena, root), "could not write the AST cache");
+    check(astCachePath(code).find("-v" + to_string(AST_CACHE_VERSION) + ".ast") != string::npos,
+          "the cache entry name does not carry the format version");
+
+    ASTArena loaded;
+    NodeId loadedRoot = loadCachedAST(code, loaded);
+    check(loadedRoot != NO_NODE && render(loaded, loadedRoot) == render(arena, root), "the cached tree came back different");
+
+    // Point the first child id past every node
+    string path = astCachePath(code);
+    fstream file(path, ios::in | ios::out | ios::binary);
+    file.seekp(sizeof(ASTCacheHeader) + 3 * sizeof(uint64_t) + arena.size() * sizeof(ASTNode));
+    NodeId bad = 0xFFFFFF;
+    file.write(reinterpret_cast<const char *>(&bad), sizeof(bad));
+    file.close();
+    check(loadCachedAST(code, loaded) == NO_NODE && loaded.size() == 0, "a damaged cache entry was loaded");
+    error_code ignored;
+    filesystem::remove(path, ignored);
+    filesystem::remove(AST_CACHE_DIRECTORY, ignored);  // Only if nothing else is cached there
+}
+
+}  // namespace
+
+int main() {
+    checkTree("Put a = 1 - (b + c);", "States(Assign(a Expr(-(R(1) +(R(b) R(c))))))", 0);
+    checkTree("Print(-a + 2);", "States(Out(Expr(+(-(R(a)) R(2)))))", 0);
+
+    // Parentheses an error leaves open are dropped, not made into nodes
+    checkTree("Print((a + (1 - b; Read(c);", "States(Out(Expr(+(R(a) -(R(1) R(b))))) In(c))", 1);
+    checkTree("Put x = ((y;", "States(Assign(x Expr(R(y))))", 1);
+
+    checkCache();
+    return 0;
+}
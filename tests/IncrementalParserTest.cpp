@@ -0,0 +1,174 @@
+// The final parser's incremental path against its whole-program one. Random
+// programs are edited a few lines at a time; after every edit the tokens
+// LexicalAnalyzer::reanalyze keeps must be those analyze() gives for the
+// edited program, and the tree and diagnostics IncrementalParser builds must
+// be those of a fresh Parser. Also checks that a statement whose hash
+// collides with a remembered one is parsed, not given the other's subtree,
+// and that a long run of edits leaves the arena and memo bounded.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#define main finalParserMain
+#include "Frontend/401130253/کد نهایی با رفع ابهام و خطایابی.cpp"
+#undef main
+
+#include "Check.hpp"
+
+namespace {
+
+const char *const SNIPPETS[] = {
+    "Put a = a + 1 - b;", "Read(b);", "Print(a + (b - 3));", "If (a > b) { Put a = 1; }",
+    "Iteration (a < 10) { Print(a); }", "Put = ;", "If (a > b) {", "}", "Print(a",
+    "Iteration (a < b) { If (a == b) { Read(c); } }", "Put x = -(-y);", "@@", "", "Read(c); Print(c);"};
+
+// "value(child child ...)", or just "value" for a leaf
+string render(const ASTArena &arena, NodeId node) {
+    string out(arena.value(node));
+    if (arena.childCount(node) > 0) {
+        out += '(';
+        for (size_t i = 0; i < arena.childCount(node); i++) {
+            if (i > 0) out += ' ';
+            out += render(arena, arena.child(node, i));
+        }
+        out += ')';
+    }
+    return out;
+}
+
+// The program's lines, joined by newlines, with one after the last line or not
+string join(const vector<string> &lines, bool finalNewline) {
+    string code;
+    for (size_t i = 0; i < lines.size(); i++) {
+        code += lines[i];
+        if (i + 1 < lines.size() || finalNewline) code += '\n';
+    }
+    return code;
+}
+
+void checkTokens(const LexicalAnalyzer &lexer, const string &code, const string &when) {
+    LexicalAnalyzer fresh;
+    fresh.analyze(code);
+    const vector<Token> &expected = fresh.getTokens();
+    const vector<Token> &actual = lexer.getTokens();
+    check(actual.size() == expected.size(), when + ": " + to_string(actual.size()) + " tokens, expected " +
+          to_string(expected.size()));
+    for (size_t i = 0; i < expected.size(); i++) {
+        const Token &a = actual[i];
+        const Token &e = expected[i];
+        check(a.kind == e.kind && a.value == e.value && a.line == e.line && a.column == e.column && a.name == e.name,
+              when + ": token " + to_string(i) + " is '" + a.value + "' at " + to_string(a.line) + ":" +
+              to_string(a.column) + ", expected '" + e.value + "' at " + to_string(e.line) + ":" + to_string(e.column));
+    }
+}
+
+// Returns the size of a fresh parse's arena
+size_t checkTree(const IncrementalParser &parser, NodeId root, const vector<Token> &tokens, const string &when) {
+    ASTArena arena;
+    Parser fresh(tokens, arena);
+    NodeId freshRoot = fresh.parse();
+    check(render(parser.getArena(), root) == render(arena, freshRoot), when + ": the tree differs from a full parse");
+    check(parser.getDiagnostics() == fresh.getDiagnostics(), when + ": the diagnostics differ from a full parse");
+    return arena.size();
+}
+
+// Replaces `oldCount` lines at `at` (from 0) with `newCount` random ones
+void editLines(vector<string> &lines, mt19937 &random, size_t at, size_t oldCount, size_t newCount) {
+    lines.erase(lines.begin() + at, lines.begin() + at + oldCount);
+    for (size_t i = 0; i < newCount; i++) {
+        lines.insert(lines.begin() + at + i, SNIPPETS[random() % size(SNIPPETS)]);
+    }
+}
+
+void checkRandomEdits() {
+    mt19937 random(25);
+    for (int round = 0; round < 150; round++) {
+        bool finalNewline = round % 3 != 0;
+        vector<string> lines;
+        for (size_t i = 1 + random() % 60; i > 0; i--) lines.push_back(SNIPPETS[random() % size(SNIPPETS)]);
+        string code = join(lines, finalNewline);
+        LexicalAnalyzer lexer;
+        lexer.analyze(code);
+        IncrementalParser parser;
+        checkTree(parser, parser.parse(lexer.getTokens()), lexer.getTokens(), "round " + to_string(round));
+
+        for (int step = 0; step < 30; step++) {
+            string when = "round " + to_string(round) + " step " + to_string(step);
+            // Sometimes two edits reach the tokens before the next parse
+            for (int edits = 1 + (random() % 4 == 0); edits > 0; edits--) {
+                // Without a final newline, adding lines after the last one or
+                // deleting the last ones also changes the line before them
+                size_t at = random() % (lines.size() + finalNewline);
+                size_t oldCount = min<size_t>(random() % 3, lines.size() - at);
+                size_t newCount = random() % 3;
+                if (!finalNewline && at + oldCount == lines.size() && newCount == 0) newCount = 1;
+                if (lines.size() - oldCount + newCount == 0) newCount = 1;
+                editLines(lines, random, at, oldCount, newCount);
+                code = join(lines, finalNewline);
+                lexer.reanalyze(code, static_cast<int>(at) + 1, static_cast<int>(oldCount), static_cast<int>(newCount));
+                checkTokens(lexer, code, when);
+            }
+            checkTree(parser, parser.parse(lexer.getTokens()), lexer.getTokens(), when);
+        }
+    }
+}
+
+// Files the subtree of "Read(a);" under the hash of "Read(b);", as a hash
+// collision would, and parses "Read(b);" with that memo.
+void checkCollision() {
+    LexicalAnalyzer first, second;
+    first.analyze("Read(a);\n");
+    second.analyze("Read(b);\n");
+    ASTArena arena;
+    StatementMemo memo;
+    Parser(first.getTokens(), arena, &memo).parse();
+    check(memo.entries.size() == 1, "\"Read(a);\" was not remembered");
+
+    uint64_t collidingKey = hashTokens(second.getTokens(), 0, second.getTokens().size());
+    memo.entries[collidingKey] = memo.entries.begin()->second;
+    memo.entries[collidingKey].key = collidingKey;
+    swap(memo.order, memo.nextOrder);  // As IncrementalParser does between parses
+    memo.nextOrder.clear();
+    memo.reused = 0;
+    memo.parsed = 0;
+    NodeId root = Parser(second.getTokens(), arena, &memo).parse();
+    check(render(arena, root) == "States(In(b))", "a colliding statement parsed to " + render(arena, root));
+    check(memo.reused == 0 && memo.parsed == 1, "a colliding statement was reused");
+}
+
+// Many edits to one program keep the arena within twice what is live, and
+// the memo to about the statements in the program.
+void checkBounded() {
+    mt19937 random(2025);
+    vector<string> lines;
+    for (int i = 0; i < 600; i++) lines.push_back("Put a = b + " + to_string(i) + " - c;");
+    string code = join(lines, true);
+    LexicalAnalyzer lexer;
+    lexer.analyze(code);
+    IncrementalParser parser;
+    parser.parse(lexer.getTokens());
+    for (int step = 0; step < 2000; step++) {
+        size_t at = random() % lines.size();
+        lines[at] = "Put a = b + " + to_string(1000 + step) + " - c;";  // Never seen before
+        code = join(lines, true);
+        lexer.reanalyze(code, static_cast<int>(at) + 1, 1, 1);
+        NodeId root = parser.parse(lexer.getTokens());
+        if (step % 100 != 99) continue;
+        string when = "after " + to_string(step + 1) + " edits";
+        size_t live = checkTree(parser, root, lexer.getTokens(), when);
+        check(parser.getArena().size() < 2 * live + 4096, when + ": the arena holds " +
+              to_string(parser.getArena().size()) + " nodes for a tree of " + to_string(live));
+        check(parser.getMemo().entries.size() < 2 * lines.size() + 16, when + ": the memo holds " +
+              to_string(parser.getMemo().entries.size()) + " statements for " + to_string(lines.size()) + " lines");
+    }
+}
+
+}  // namespace
+
+int main() {
+    checkRandomEdits();
+    checkCollision();
+    checkBounded();
+    return 0;
+}
@@ -0,0 +1,139 @@
+// Edits documents at random and checks, after every update, that the
+// IncrementalScanner holds exactly the tokens a Scanner of the whole edited
+// document produces: same types, offsets, lengths, lines, columns and
+// symbols. Edits land anywhere, in groups, across block boundaries and on
+// the last line, which may or may not end in a newline.
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include "Frontend/IncrementalScanner.hpp"
+#include "Check.hpp"
+
+namespace {
+
+const char* const PIECES[] = {"var x = 1;", "  int a=b+c*2;", "", "y = 3.5 ;", "   ", "foo(bar, baz) {", "}", "@#", "12. x"};
+
+// The document as lines, each with its '\n' but the last, which has none and may be empty
+using Lines = std::vector<std::string>;
+
+std::string join(const Lines& lines) {
+    std::string document;
+    for (const std::string& line : lines) document += line;
+    return document;
+}
+
+std::vector<Token> scanWhole(const std::string& document) {
+    std::vector<Token> tokens;
+    Scanner scanner(document);
+    for (Token token; scanner.nextToken(token);) tokens.push_back(token);
+    return tokens;
+}
+
+void checkSame(const IncrementalScanner& incremental, const std::string& document, const std::string& when) {
+    std::vector<Token> expected = scanWhole(document);
+    std::vector<Token> actual = incremental.tokens();
+    check(incremental.tokenCount() == expected.size() && actual.size() == expected.size(),
+          when + ": " + std::to_string(actual.size()) + " tokens, expected " + std::to_string(expected.size()));
+    for (std::size_t i = 0; i < expected.size(); i++) {
+        const Token& a = actual[i];
+        const Token& e = expected[i];
+        check(a.type == e.type && a.offset == e.offset && a.length == e.length && a.line == e.line &&
+              a.column == e.column && a.symbol == e.symbol,
+              when + ": token " + std::to_string(i) + " is at offset " + std::to_string(a.offset) + " (line " +
+              std::to_string(a.line) + " column " + std::to_string(a.column) + "), expected offset " +
+              std::to_string(e.offset) + " (line " + std::to_string(e.line) + " column " + std::to_string(e.column) + ")");
+    }
+}
+
+class RandomEdits {
+public:
+    explicit RandomEdits(unsigned seed) : random(seed) {}
+
+    std::string line(bool last) {
+        return std::string(PIECES[random() % std::size(PIECES)]) + (last ? "" : "\n");
+    }
+
+    Lines document(std::size_t lineCount) {
+        Lines lines;
+        for (std::size_t i = 0; i < lineCount; i++) lines.push_back(line(false));
+        lines.push_back(random() % 2 ? line(true) : "");
+        return lines;
+    }
+
+    // Applies up to four non-overlapping edits to `lines` and returns them as
+    // LineEdits. An edit that replaces the last line ends in a line without '\n'.
+    std::vector<LineEdit> edit(Lines& lines) {
+        int total = static_cast<int>(lines.size());
+        std::vector<int> starts;
+        for (unsigned k = 1 + random() % 4; k > 0; k--) starts.push_back(1 + static_cast<int>(random() % total));
+        if (random() % 4 == 0) starts.push_back(total);  // Often enough at the end of the document
+        std::sort(starts.begin(), starts.end());
+
+        std::vector<LineEdit> edits;
+        Lines edited;
+        int next = 1;  // First old line not yet copied
+        for (int start : starts) {
+            if (start < next) continue;
+            int oldCount = std::min(static_cast<int>(random() % 3), total - start + 1);
+            bool replacesLast = start + oldCount - 1 == total;
+            int newCount = static_cast<int>(random() % 3) + (replacesLast ? 1 : 0);
+            while (next < start) edited.push_back(lines[next++ - 1]);
+            for (int i = 0; i < newCount; i++) edited.push_back(line(replacesLast && i == newCount - 1));
+            next += oldCount;
+            edits.push_back({start, oldCount, newCount});
+        }
+        while (next <= total) edited.push_back(lines[next++ - 1]);
+        lines = std::move(edited);
+        std::shuffle(edits.begin(), edits.end(), random);  // update() takes them in any order
+        return edits;
+    }
+
+private:
+    std::mt19937 random;
+};
+
+}  // namespace
+
+int main() {
+    RandomEdits random(24);
+    for (int round = 0; round < 60; round++) {
+        // Up to a few blocks, so edits also fall on and across block boundaries
+        Lines lines = random.document(static_cast<std::size_t>(round % 6 == 0 ? round % 3 : round * 23));
+        std::string document = join(lines);
+        IncrementalScanner incremental;
+        incremental.scan(document);
+        checkSame(incremental, document, "round " + std::to_string(round) + " before any edit");
+        for (int step = 0; step < 25; step++) {
+            std::vector<LineEdit> edits = random.edit(lines);
+            document = join(lines);
+            incremental.update(document, edits);
+            checkSame(incremental, document, "round " + std::to_string(round) + " step " + std::to_string(step));
+        }
+    }
+
+    // Typing at the end of a document without a final newline, a byte at a time
+    std::string document = "var x = 1;\nfoo";
+    IncrementalScanner incremental;
+    incremental.scan(document);
+    for (char typed : std::string("(bar);\n12.5\n\ny")) {
+        int lastLine = static_cast<int>(std::count(document.begin(), document.end(), '\n')) + 1;
+        document += typed;
+        incremental.update(document, {{lastLine, 1, typed == '\n' ? 2 : 1}});
+        checkSame(incremental, document, "after typing '" + std::string(1, typed) + "' at the end");
+    }
+
+    // One line changed in a large document scans only that line
+    Lines large = random.document(100000);
+    document = join(large);
+    incremental.scan(document);
+    large[50000] = "changed = 7;\n";
+    document = join(large);
+    incremental.update(document, {{50001, 1, 1}});
+    checkSame(incremental, document, "after one edit in a large document");
+    check(incremental.rescannedBytes() == large[50000].size(),
+          "one edited line made the scanner scan " + std::to_string(incremental.rescannedBytes()) + " bytes");
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Scans sources on 1 to 8 threads and checks that ParallelScanner hands back
+// exactly the tokens a sequential Scanner does: same types, offsets,
+// lengths, lines, columns and symbols. The sources put newlines, tokens cut
+// by the split point and tokens starting right after it on every chunk edge.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "Frontend/ParallelScanner.hpp"
+#include "Check.hpp"
+
+namespace {
+
+const char* const LINES[] = {"int alpha = beta + 12;", "float x=3.25*y;", "", "  while (a <= b) { a = a - 1; }",
+                             "@#", "12. x", "\t;", "return foo(bar, baz);"};
+
+// What each chunk edge gets: the text, and where in it the split point falls
+struct EdgePattern {
+    const char* text;
+    std::size_t at;
+};
+
+const EdgePattern EDGES[] = {
+    {"\n", 0},               // The newline right at the split point
+    {";\nint", 0},           // A token starting right after the chunk's newline
+    {"identifier\n", 5},     // A name cut by the split point
+    {"\n\n\n", 1},           // Blank lines across the edge
+    {"12.5\n", 2},           // A number cut at its '.'
+    {"a<=b\n", 2},           // An operator cut in two
+    {"x \r\n  y", 2},        // A carriage return before the newline
+};
+
+std::vector<Token> scanSequentially(std::string_view source) {
+    int lineNumber = 1;
+    return Scanner().scan(source, lineNumber);
+}
+
+void checkSame(std::string_view source, unsigned threads, const std::string& what) {
+    std::vector<Token> expected = scanSequentially(source);
+    std::vector<Token> actual = ParallelScanner(threads).scan(source);
+    std::string when = what + " on " + std::to_string(threads) + " thread(s)";
+    check(actual.size() == expected.size(), when + ": " + std::to_string(actual.size()) + " tokens, expected " +
+          std::to_string(expected.size()));
+    for (std::size_t i = 0; i < expected.size(); i++) {
+        const Token& a = actual[i];
+        const Token& e = expected[i];
+        if (a.type == e.type && a.offset == e.offset && a.length == e.length && a.line == e.line &&
+            a.column == e.column && a.symbol == e.symbol) {
+            continue;
+        }
+        check(false, when + ": token " + std::to_string(i) + " is at offset " + std::to_string(a.offset) + " (line " +
+              std::to_string(a.line) + " column " + std::to_string(a.column) + "), expected offset " +
+              std::to_string(e.offset) + " (line " + std::to_string(e.line) + " column " + std::to_string(e.column) + ")");
+    }
+}
+
+// About `size` bytes of random lines, ending in a newline or not
+std::string randomSource(std::size_t size, std::mt19937& random, bool finalNewline) {
+    std::string source;
+    while (source.size() < size) {
+        source += LINES[random() % std::size(LINES)];
+        source += '\n';
+    }
+    source.resize(size);
+    if (finalNewline) source.back() = '\n';
+    else if (source.back() == '\n') source.back() = 'z';
+    return source;
+}
+
+// Overwrites the source around each point ParallelScanner will split it at
+// for `threads` threads with `edge`, following the same arithmetic as its
+// split so every chunk edge, not just the first, gets the pattern.
+void placeOnEdges(std::string& source, unsigned threads, const EdgePattern& edge) {
+    std::size_t chunkCount = std::min<std::size_t>(threads, std::max<std::size_t>(1, source.size() / ParallelScanner::MIN_CHUNK_SIZE));
+    std::size_t target = source.size() / chunkCount;
+    std::size_t begin = 0;
+    std::size_t textSize = std::strlen(edge.text);
+    for (std::size_t chunk = 0; chunk + 1 < chunkCount; chunk++) {
+        std::size_t split = begin + target;
+        if (split < edge.at || split - edge.at + textSize > source.size()) return;
+        source.replace(split - edge.at, textSize, edge.text);
+        std::size_t newline = source.find('\n', split);
+        if (newline == std::string::npos) return;
+        begin = newline + 1;
+    }
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 random(6);
+
+    // Too small to split, and nothing at all
+    for (unsigned threads = 1; threads <= 8; threads++) {
+        checkSame("", threads, "an empty source");
+        checkSame("int a = 1;\nfloat b", threads, "a small source");
+    }
+
+    for (unsigned threads = 1; threads <= 8; threads++) {
+        // Just big enough for one chunk per thread
+        std::size_t size = threads * ParallelScanner::MIN_CHUNK_SIZE + random() % 1000;
+        std::string source = randomSource(size, random, threads % 2 == 0);
+        checkSame(source, threads, "random lines");
+        for (std::size_t e = 0; e < std::size(EDGES); e++) {
+            std::string edged = source;
+            placeOnEdges(edged, threads, EDGES[e]);
+            checkSame(edged, threads, "edge pattern " + std::to_string(e));
+        }
+    }
+
+    // One long last line leaves no newline to end the later chunks at
+    std::string longLine = randomSource(ParallelScanner::MIN_CHUNK_SIZE, random, true) +
+                           std::string(4 * ParallelScanner::MIN_CHUNK_SIZE, 'a') + " b";
+    for (unsigned threads = 1; threads <= 8; threads++) {
+        checkSame(longLine, threads, "a long last line");
+    }
+    return 0;
+}
@@ -0,0 +1,184 @@
+// Parses sources with syntax errors in several declarations and checks that
+// one pass reports every one of them at the right line and column, that
+// parsing picks up again at the next declaration, and that each broken
+// declaration is left in the tree as an Error node over what parsed before
+// the error. Every tree is also checked against the flat post-order layout
+// AstView promises, and one is compared node by node.
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Frontend/Parser.hpp"
+#include "Frontend/Scanner.hpp"
+#include "Check.hpp"
+
+namespace {
+
+struct Parsed {
+    std::vector<Token> tokens;
+    std::string diagnostics;  // As Diagnostics::print writes them
+    std::string tree;
+    std::vector<AstNode> nodes;
+    bool ok;
+};
+
+// Every subtree is the run of `span` nodes ending at its root, made of its
+// children's runs back to back, and the root is the last node
+void checkLayout(AstView ast, std::size_t tokenCount, const std::string& what) {
+    check(!ast.empty() && ast[ast.root()].kind == AstKind::Program && ast[ast.root()].span == ast.size(),
+          what + ": the last node is not a Program spanning the whole tree");
+    for (AstIndex index = 0; index < ast.size(); index++) {
+        const AstNode& node = ast[index];
+        std::string at = what + ": node " + std::to_string(index);
+        check(node.span >= 1 && node.span <= index + 1, at + " spans past the front of the tree");
+        check(node.token <= tokenCount, at + " refers past the tokens");
+        std::uint32_t covered = 1;
+        AstIndex child = AstView::lastChild(index);
+        for (std::uint32_t i = 0; i < node.childCount; i++, child = ast.previousSibling(child)) {
+            check(covered < node.span, at + " has more children than its span holds");
+            covered += ast[child].span;
+        }
+        check(covered == node.span, at + " spans " + std::to_string(node.span) + " nodes but its children cover " +
+              std::to_string(covered - 1));
+        if (node.kind == AstKind::Identifier || node.kind == AstKind::Number) {
+            check(node.childCount == 0, at + " is a leaf with children");
+        } else if (node.kind == AstKind::Unary || node.kind == AstKind::Binary) {
+            check(node.childCount == (node.kind == AstKind::Unary ? 1u : 2u), at + " has the wrong number of operands");
+        }
+    }
+}
+
+// "Kind[token](child child ...)", without brackets for a node past the last
+// token and without parentheses for a leaf
+std::string render(AstView ast, AstIndex index, const std::vector<Token>& tokens, std::string_view source) {
+    const AstNode& node = ast[index];
+    std::string out = getAstKindName(node.kind);
+    if (node.token < tokens.size()) {
+        out += "[" + std::string(tokens[node.token].text(source)) + "]";
+    }
+    std::vector<AstIndex> children;
+    AstIndex child = AstView::lastChild(index);
+    for (std::uint32_t i = 0; i < node.childCount; i++, child = ast.previousSibling(child)) {
+        children.push_back(child);
+    }
+    std::reverse(children.begin(), children.end());
+    for (std::size_t i = 0; i < children.size(); i++) {
+        out += i == 0 ? "(" : " ";
+        out += render(ast, children[i], tokens, source);
+    }
+    return children.empty() ? out : out + ")";
+}
+
+Parsed parse(std::string_view source) {
+    Parsed parsed;
+    Scanner scanner(source);
+    for (Token token; scanner.nextToken(token);) {
+        parsed.tokens.push_back(token);
+    }
+    VectorTokenSource tokenSource(parsed.tokens);
+    TokenStream stream(tokenSource);
+    Parser parser(stream, source);
+    parsed.ok = parser.Parse();
+    std::ostringstream out;
+    parser.getDiagnostics().print(out);
+    parsed.diagnostics = out.str();
+    AstView ast = parser.getAst().view();
+    checkLayout(ast, parsed.tokens.size(), "\"" + std::string(source) + "\"");
+    parsed.tree = render(ast, ast.root(), parsed.tokens, source);
+    parsed.nodes = parser.getAst().nodes();
+    return parsed;
+}
+
+void checkParse(std::string_view source, const std::string& expectedDiagnostics, const std::string& expectedTree) {
+    Parsed parsed = parse(source);
+    std::string what = "\"" + std::string(source) + "\"";
+    check(parsed.ok == expectedDiagnostics.empty(), what + (parsed.ok ? " parsed without errors" : " failed to parse"));
+    check(parsed.diagnostics == expectedDiagnostics,
+          what + " reported\n" + parsed.diagnostics + "expected\n" + expectedDiagnostics);
+    check(parsed.tree == expectedTree, what + " parsed to " + parsed.tree + ", expected " + expectedTree);
+}
+
+// The nodes of `source` in array order, as kind, token position, child count and span
+void checkNodes(std::string_view source, const std::vector<AstNode>& expected) {
+    std::vector<AstNode> nodes = parse(source).nodes;
+    std::string what = "\"" + std::string(source) + "\"";
+    check(nodes.size() == expected.size(), what + " has " + std::to_string(nodes.size()) + " nodes, expected " +
+          std::to_string(expected.size()));
+    for (std::size_t i = 0; i < expected.size(); i++) {
+        const AstNode& a = nodes[i];
+        const AstNode& e = expected[i];
+        check(a.kind == e.kind && a.token == e.token && a.childCount == e.childCount && a.span == e.span,
+              what + ": node " + std::to_string(i) + " is " + getAstKindName(a.kind) + " at token " +
+              std::to_string(a.token) + " with " + std::to_string(a.childCount) + " children over " +
+              std::to_string(a.span) + " nodes, expected " + getAstKindName(e.kind) + " at token " +
+              std::to_string(e.token) + " with " + std::to_string(e.childCount) + " children over " +
+              std::to_string(e.span) + " nodes");
+    }
+}
+
+}  // namespace
+
+int main() {
+    checkParse("int a = 1;\nfloat b = -(a + 2) * 3;\n", "",
+               "Program(VarDec[int](Identifier[a] Number[1]) "
+               "VarDec[float](Identifier[b] Binary[*](Unary[-](Binary[+](Identifier[a] Number[2])) Number[3])))");
+
+    // Children right before their parent, operands in postfix order, and
+    // the Program past the last token
+    checkNodes("int a = 1;\nfloat b = -(a + 2) * 3;\n", {
+        {AstKind::Identifier, 1, 0, 1},
+        {AstKind::Number, 3, 0, 1},
+        {AstKind::VarDec, 0, 2, 3},
+        {AstKind::Identifier, 6, 0, 1},
+        {AstKind::Identifier, 10, 0, 1},
+        {AstKind::Number, 12, 0, 1},
+        {AstKind::Binary, 11, 2, 3},
+        {AstKind::Unary, 8, 1, 4},
+        {AstKind::Number, 15, 0, 1},
+        {AstKind::Binary, 14, 2, 6},
+        {AstKind::VarDec, 5, 2, 8},
+        {AstKind::Program, 17, 2, 12},
+    });
+    checkNodes("double d;", {
+        {AstKind::Identifier, 1, 0, 1},
+        {AstKind::VarDec, 0, 1, 2},
+        {AstKind::Program, 3, 1, 3},
+    });
+    checkNodes("", {{AstKind::Program, 0, 0, 1}});
+
+    // One error in each of four declarations, between two good ones: every
+    // error is reported, the good declarations after them still parse, and
+    // each bad one keeps what came before its error
+    checkParse("int a = 1;\n"
+               "float = 2;\n"
+               "int b = * 3;\n"
+               "double c 4;\n"
+               "let d = (1 + 2;\n"
+               "char e;\n",
+               "Syntax Error: Expected Identifier but got = at line 2, column 7\n"
+               "Syntax Error: Expected Identifier, Number or ( but got * at line 3, column 9\n"
+               "Syntax Error: Expected = or ; but got 4 at line 4, column 10\n"
+               "Syntax Error: Expected ) but got ; at line 5, column 15\n",
+               "Program(VarDec[int](Identifier[a] Number[1]) "
+               "Error[=] "
+               "Error[*](Identifier[b]) "
+               "Error[4](Identifier[c]) "
+               "Error[;](Identifier[d]) "
+               "VarDec[char](Identifier[e]))");
+
+    // A declaration that does not start with a type fails the declaration
+    // list itself; parsing goes on after its ';', up to a ';' missing at the end
+    checkParse("x = 1;\nint f = 2",
+               "Syntax Error: Expected Type or End but got x at line 1, column 1\n"
+               "Syntax Error: Expected ; but got end of input at line 2, column 10\n",
+               "Program(Error[x] Error(Identifier[f] Number[2]))");
+
+    // Skipping stops at the next type keyword even without a ';'
+    checkParse("int g = 1 + ;\nint h = 5;\nfloat 7 int i;",
+               "Syntax Error: Expected Identifier, Number or ( but got ; at line 1, column 13\n"
+               "Syntax Error: Expected Identifier but got 7 at line 3, column 7\n",
+               "Program(Error[;](Identifier[g]) VarDec[int](Identifier[h] Number[5]) Error[7] "
+               "VarDec[int](Identifier[i]))");
+    return 0;
+}
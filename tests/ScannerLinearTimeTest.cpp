@@ -0,0 +1,83 @@
+// Guards the scanner against inputs that once made it quadratic: long
+// operator runs, long identifiers and digit strings, and patterns that make
+// maximal munch back up. Each is scanned at two sizes four times apart; the
+// tokens must tile the input exactly, and the larger input may take only
+// about four times as long. A quadratic scan would take sixteen.
+
+#include <chrono>
+#include <string>
+#include "Frontend/Scanner.hpp"
+#include "Check.hpp"
+
+namespace {
+
+struct ScanResult {
+    std::size_t tokens = 0;
+    double seconds = 0;
+};
+
+std::string repeat(const std::string& pattern, std::size_t bytes) {
+    std::string input;
+    input.reserve(bytes + pattern.size());
+    while (input.size() < bytes) {
+        input += pattern;
+    }
+    return input;
+}
+
+// Streams `input` through nextToken, checking that every token starts where
+// the previous one ended; the inputs have no whitespace.
+ScanResult scanTimed(const std::string& name, const std::string& input) {
+    ScanResult best;
+    for (int round = 0; round < 3; round++) {
+        auto start = std::chrono::steady_clock::now();
+        Scanner scanner(input);
+        std::size_t tokens = 0;
+        std::uint32_t end = 0;
+        for (Token token; scanner.nextToken(token);) {
+            check(token.offset == end && token.length > 0, name + ": token " + std::to_string(tokens) +
+                  " at offset " + std::to_string(token.offset) + ", expected " + std::to_string(end));
+            end = token.offset + token.length;
+            tokens++;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        check(end == input.size(), name + ": tokens stop at " + std::to_string(end) + " of " + std::to_string(input.size()));
+        if (round == 0 || seconds < best.seconds) best.seconds = seconds;
+        best.tokens = tokens;
+    }
+    return best;
+}
+
+void checkLinear(const std::string& name, const std::string& small, const std::string& large,
+                 std::size_t smallTokens, std::size_t largeTokens) {
+    ScanResult smallScan = scanTimed(name, small);
+    ScanResult largeScan = scanTimed(name, large);
+    check(smallScan.tokens == smallTokens && largeScan.tokens == largeTokens,
+          name + ": " + std::to_string(smallScan.tokens) + " and " + std::to_string(largeScan.tokens) +
+          " tokens, expected " + std::to_string(smallTokens) + " and " + std::to_string(largeTokens));
+    double ratio = largeScan.seconds / smallScan.seconds;
+    std::cout << name << ": " << small.size() << " -> " << large.size() << " bytes, time x" << ratio << '\n';
+    check(ratio < 8, name + ": four times the input took " + std::to_string(ratio) + " times as long");
+}
+
+}  // namespace
+
+int main() {
+    const std::size_t small = 1 << 18;
+    const std::size_t large = 4 * small;
+
+    // "+++..." munches into "++" pairs
+    checkLinear("operator run", std::string(small, '+'), std::string(large, '+'), small / 2, large / 2);
+
+    // Three-character operators followed by prefixes of others: <<=, ->, &&
+    std::string mixed = "<<=->&&";
+    checkLinear("mixed operators", repeat(mixed, small), repeat(mixed, large),
+                3 * repeat(mixed, small).size() / mixed.size(), 3 * repeat(mixed, large).size() / mixed.size());
+
+    checkLinear("identifier", "x" + std::string(small, 'a'), "x" + std::string(large, 'a'), 1, 1);
+    checkLinear("digits", std::string(small, '7') + ".5", std::string(large, '7') + ".5", 1, 1);
+
+    // "1.1" is a number and the next '.' stands alone, so every other dot makes the DFA back up
+    checkLinear("dotted numbers", repeat("1.", small), repeat("1.", large), small / 2, large / 2);
+    return 0;
+}
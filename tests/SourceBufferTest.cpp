@@ -0,0 +1,66 @@
+// Opens sources at and just past a size limit. One past it must be refused
+// with an error that says so rather than mapped, since token offsets are 32
+// bits and would wrap; the default limit is tried on sparse files, which
+// take no disk space for the gigabytes they claim.
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include "Frontend/SourceBuffer.hpp"
+#include "Check.hpp"
+
+namespace {
+
+void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Opens `path` under `limit`, expecting it to fit or not
+void checkOpen(const std::string& path, std::size_t limit, bool fits, std::size_t size) {
+    SourceBuffer source;
+    bool opened = source.open(path, limit);
+    std::string what = "a " + std::to_string(size) + "-byte file under a " + std::to_string(limit) + "-byte limit";
+    if (fits) {
+        check(opened, what + " was refused: " + source.getError());
+        check(source.size() == size && source.getError().empty(), what + " opened as " + std::to_string(source.size()) +
+              " bytes");
+        return;
+    }
+    check(!opened && source.size() == 0, what + " was opened");
+    std::string expected = "Could not open the file " + path + ": it is over " + std::to_string(limit) + " bytes long";
+    check(source.getError() == expected, what + " failed with \"" + source.getError() + "\"");
+}
+
+}  // namespace
+
+int main() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                      ("hut-source-buffer-test-" + std::to_string(std::random_device{}()));
+    std::filesystem::create_directories(directory);
+    std::string path = (directory / "source.hol").string();
+
+    writeFile(path, "int a;\n");
+    checkOpen(path, 7, true, 7);
+    checkOpen(path, 6, false, 7);
+    checkOpen(path, 0, false, 7);
+
+    // An empty file is never mapped, but still has to fit
+    writeFile(path, "");
+    checkOpen(path, 0, true, 0);
+
+    SourceBuffer missing;
+    check(!missing.open((directory / "missing.hol").string()), "a missing file was opened");
+    check(missing.getError() == "Could not open the file " + (directory / "missing.hol").string(),
+          "a missing file failed with \"" + missing.getError() + "\"");
+
+    std::filesystem::resize_file(path, SourceBuffer::MAX_SOURCE_SIZE + std::uintmax_t(1));
+    checkOpen(path, SourceBuffer::MAX_SOURCE_SIZE, false, SourceBuffer::MAX_SOURCE_SIZE + std::size_t(1));
+    std::filesystem::resize_file(path, SourceBuffer::MAX_SOURCE_SIZE);
+    checkOpen(path, SourceBuffer::MAX_SOURCE_SIZE, true, SourceBuffer::MAX_SOURCE_SIZE);
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
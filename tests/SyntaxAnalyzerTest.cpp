@@ -0,0 +1,84 @@
+// The semantic checks the 401130253 syntax analyzer makes with its symbol
+// table: a variable declared twice, and one used without being declared,
+// are reported at the offending name. Names that differ only in case or
+// length are different variables.
+
+#include <string>
+#include <vector>
+
+#include "Frontend/401130253/تحلیلگر نحوی.cpp"
+
+#include "Check.hpp"
+
+namespace {
+
+vector<string> diagnose(const string &code) {
+    LexicalAnalyzer lexer;
+    lexer.analyze(code);
+    ASTArena arena;
+    Parser parser(lexer.getTokens(), arena);
+    parser.parse();
+    return parser.getDiagnostics();
+}
+
+void checkDiagnostics(const string &code, const vector<string> &expected) {
+    vector<string> actual = diagnose(code);
+    string listed;
+    for (const string &line : actual) listed += "\n  " + line;
+    check(actual == expected, "\"" + code + "\" reported" + (listed.empty() ? " nothing" : listed));
+}
+
+// The `i`-th five-letter name, in an order that mixes case
+string nameNumber(size_t i) {
+    string name;
+    for (int letter = 0; letter < 5; letter++, i /= 52) {
+        size_t digit = i % 52;
+        name += static_cast<char>(digit < 26 ? 'a' + digit : 'A' + digit - 26);
+    }
+    return name;
+}
+
+}  // namespace
+
+int main() {
+    checkDiagnostics("Program Var a; Var b; Start Read(a); Put b = a + 1; Print(b); End End", {});
+
+    checkDiagnostics("Program\nVar a;\nVar b;\nVar a;\nStart\nPrint(a + b);\nEnd\nEnd",
+                     {"Semantic Error: Variable 'a' redeclared (first declared on line 2). at line 4, column 5"});
+
+    // Every place a name is used: Read, the target of Put, and expressions
+    checkDiagnostics("Program\nVar a;\nStart\nRead(x);\nPut y = a + z;\nIf (w > a) { Print(a); }\nEnd\nEnd",
+                     {"Semantic Error: Undeclared variable 'x'. at line 4, column 6",
+                      "Semantic Error: Undeclared variable 'y'. at line 5, column 5",
+                      "Semantic Error: Undeclared variable 'z'. at line 5, column 13",
+                      "Semantic Error: Undeclared variable 'w'. at line 6, column 5"});
+
+    checkDiagnostics("Program Var ab; Var abc; Var Ab; Start Print(ab + abc - Ab + abcd + aB); End End",
+                     {"Semantic Error: Undeclared variable 'abcd'. at line 1, column 62",
+                      "Semantic Error: Undeclared variable 'aB'. at line 1, column 69"});
+
+    // Semantic errors are reported alongside syntax errors, not instead of them
+    checkDiagnostics("Program Var a; Var a Start Print(b); End End",
+                     {"Semantic Error: Variable 'a' redeclared (first declared on line 1). at line 1, column 20",
+                      "Syntax Error: Expected ';' after variable declaration. at line 1, column 22",
+                      "Semantic Error: Undeclared variable 'b'. at line 1, column 34"});
+
+    // Many names, each declared once and used once
+    string code = "Program\n";
+    string uses;
+    for (size_t i = 0; i < 5000; i++) {
+        code += "Var " + nameNumber(i * 7919) + ";\n";
+        uses += "Print(" + nameNumber(i * 7919) + ");\n";
+    }
+    code += "Start\n" + uses + "End\nEnd\n";
+    LexicalAnalyzer lexer;
+    lexer.analyze(code);
+    ASTArena arena;
+    Parser parser(lexer.getTokens(), arena);
+    parser.parse();
+    check(parser.getDiagnostics().empty(), "5000 declared names gave \"" +
+          (parser.getDiagnostics().empty() ? string() : parser.getDiagnostics().front()) + "\"");
+    check(parser.getSymbols().size() == 5000, "the symbol table holds " + to_string(parser.getSymbols().size()) +
+          " names, expected 5000");
+    return 0;
+}
@@ -0,0 +1,157 @@
+// Writes a .tok file with `HUT_Compiler --emit-tokens=bin` and replays it
+// through CachedTokenSource, which must hand back exactly the tokens a
+// Scanner gives for the source: same types, offsets, lengths, lines, columns
+// and symbols. Then damages the file: a truncated one is refused, and a
+// replay stops at a record that is out of order instead of making up lines
+// and columns from it, or one that points outside the source.
+//
+// Usage: TokenCacheTest <path to HUT_Compiler>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Frontend/Scanner.hpp"
+#include "Frontend/TokenCache.hpp"
+#include "Check.hpp"
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+std::vector<Token> scanWhole(std::string_view source) {
+    std::vector<Token> tokens;
+    Scanner scanner(source);
+    for (Token token; scanner.nextToken(token);) tokens.push_back(token);
+    return tokens;
+}
+
+// Every token the cache replays, until it runs out or stops at a damaged record
+std::vector<Token> replayAll(CachedTokenSource& cached) {
+    std::vector<Token> tokens;
+    for (Token token; cached.nextToken(token);) tokens.push_back(token);
+    return tokens;
+}
+
+// `actual` must be the first actual.size() tokens of `expected`
+void checkPrefix(const std::vector<Token>& actual, const std::vector<Token>& expected, const std::string& what) {
+    check(actual.size() <= expected.size(), what + ": " + std::to_string(actual.size()) + " tokens, more than the " +
+          std::to_string(expected.size()) + " scanned");
+    for (std::size_t i = 0; i < actual.size(); i++) {
+        const Token& a = actual[i];
+        const Token& e = expected[i];
+        if (a.type == e.type && a.offset == e.offset && a.length == e.length && a.line == e.line &&
+            a.column == e.column && a.symbol == e.symbol) {
+            continue;
+        }
+        check(false, what + ": token " + std::to_string(i) + " is at offset " + std::to_string(a.offset) + " (line " +
+              std::to_string(a.line) + " column " + std::to_string(a.column) + "), expected offset " +
+              std::to_string(e.offset) + " (line " + std::to_string(e.line) + " column " + std::to_string(e.column) + ")");
+    }
+}
+
+// Swaps records `i` and `j` of the cache in `bytes`
+std::string swapRecords(std::string bytes, std::size_t i, std::size_t j) {
+    std::size_t first = sizeof(TokenCacheHeader) + i * sizeof(TokenRecord);
+    std::size_t second = sizeof(TokenCacheHeader) + j * sizeof(TokenRecord);
+    for (std::size_t k = 0; k < sizeof(TokenRecord); k++) {
+        std::swap(bytes[first + k], bytes[second + k]);
+    }
+    return bytes;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    check(argc > 1, "usage: TokenCacheTest <path to HUT_Compiler>");
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                      ("hut-token-cache-test-" + std::to_string(std::random_device{}()));
+    std::filesystem::create_directories(directory);
+    std::string sourcePath = (directory / "source.hol").string();
+    std::string source = "int alpha = 1;\n\n  float beta = -(alpha + 2) * 3.5;\n\tlet c = beta;\n\ndouble d;";
+    writeFile(sourcePath, source);
+
+    std::string command = "\"" + std::string(argv[1]) + "\" --emit-tokens=bin \"" + sourcePath + "\"";
+    check(std::system(command.c_str()) == 0, "\"" + command + "\" failed");
+    std::string cachePath = tokenCachePath(sourcePath);
+    std::string original = readFile(cachePath);
+    std::vector<Token> expected = scanWhole(source);
+
+    {
+        CachedTokenSource cached;
+        check(cached.open(cachePath, source), "the written cache was refused");
+        check(cached.size() == expected.size(), "the cache holds " + std::to_string(cached.size()) + " tokens, expected " +
+              std::to_string(expected.size()));
+        std::vector<Token> replayed = replayAll(cached);
+        checkPrefix(replayed, expected, "the written cache");
+        check(replayed.size() == expected.size(), "the written cache stopped after " +
+              std::to_string(replayed.size()) + " tokens");
+    }
+
+    // A source edited since the cache was written
+    {
+        CachedTokenSource cached;
+        std::string edited = source;
+        edited[0] = 'I';
+        check(!cached.open(cachePath, edited), "a cache was used for a different source");
+    }
+
+    // Cut anywhere past the header, including on a record boundary
+    for (std::size_t cut : {original.size() - 1, original.size() - sizeof(TokenRecord), sizeof(TokenCacheHeader) + 3,
+                            sizeof(TokenCacheHeader) - 1, std::size_t(0)}) {
+        writeFile(cachePath, original.substr(0, cut));
+        CachedTokenSource cached;
+        check(!cached.open(cachePath, source), "a cache cut to " + std::to_string(cut) + " bytes was used");
+    }
+
+    // Records i < j swapped: record j, moved forward, still looks in order
+    // on its own, but the replay stops at the record after it, which goes
+    // back, and everything before is untouched
+    for (std::size_t i = 0; i + 1 < expected.size(); i++) {
+        for (std::size_t j : {i + 1, expected.size() - 1}) {
+            if (j == i) continue;
+            writeFile(cachePath, swapRecords(original, i, j));
+            CachedTokenSource cached;
+            check(cached.open(cachePath, source), "a cache with records swapped was refused at open");
+            std::vector<Token> replayed = replayAll(cached);
+            std::string what = "records " + std::to_string(i) + " and " + std::to_string(j) + " swapped";
+            check(replayed.size() == i + 1, what + ": the replay went on for " + std::to_string(replayed.size()) +
+                  " tokens, expected it to stop after " + std::to_string(i + 1));
+            checkPrefix(std::vector<Token>(replayed.begin(), replayed.end() - 1), expected, what);
+            check(replayed.back().offset == expected[j].offset, what + ": token " + std::to_string(i) +
+                  " is not the one moved there");
+        }
+    }
+
+    // A record that goes back a line, or points past the source
+    for (std::size_t field : {offsetof(TokenRecord, line), offsetof(TokenRecord, offset)}) {
+        std::size_t last = expected.size() - 1;
+        std::string damaged = original;
+        std::uint32_t value = field == offsetof(TokenRecord, line) ? 0 : static_cast<std::uint32_t>(source.size() + 1);
+        std::memcpy(&damaged[sizeof(TokenCacheHeader) + last * sizeof(TokenRecord) + field], &value, sizeof(value));
+        writeFile(cachePath, damaged);
+        CachedTokenSource cached;
+        check(cached.open(cachePath, source), "a cache with a damaged record was refused at open");
+        std::vector<Token> replayed = replayAll(cached);
+        checkPrefix(replayed, expected, "a damaged last record");
+        check(replayed.size() == last, "a damaged last record was replayed");
+    }
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}